@@ -0,0 +1,76 @@
+extends SceneTree
+## Compares viewer render settings on the files in `examples/`.
+##
+## Run from the root directory with:
+##     godot --path demo --headless --script benchmark.gd
+
+
+const EXAMPLES_DIR := "res://examples"
+const VIEWER_SIZE := Vector2(1024, 1024)
+const WARMUP_FRAMES := 10
+const FRAMES := 120
+
+## Property name -> values to compare. Every other property keeps its default.
+const CASES := {
+	"pixel_format": [0, 1, 2, 3, 4],
+	"antialiasing": [0, 1, 2],
+	"layer_cache": [false, true],
+}
+
+## Property name -> files it's compared on. Properties not listed here run on every file.
+const CASE_FILES := {
+	"antialiasing": ["bullet_man.riv", "off_road_car.riv"],
+	"layer_cache": ["walle.riv", "rocket.riv"],
+}
+
+func _initialize() -> void:
+	_run()
+
+
+func _run() -> void:
+	print("file,property,value,avg_frame_ms,upload_kb")
+	for file in _example_files():
+		for property in CASES:
+			if property in CASE_FILES and not file.get_file() in CASE_FILES[property]:
+				continue
+			for value in CASES[property]:
+				var result: Array = await _measure(file, property, value)
+				print("{0},{1},{2},{3},{4}".format([file.get_file(), property, value, "%.3f" % result[0], "%.1f" % result[1]]))
+	quit()
+
+
+func _example_files() -> PackedStringArray:
+	var files := PackedStringArray()
+	for file in DirAccess.get_files_at(EXAMPLES_DIR):
+		if file.get_extension() == "riv": files.append(EXAMPLES_DIR.path_join(file))
+	return files
+
+
+func _make_viewer(path: String) -> RiveViewer:
+	var viewer := RiveViewer.new()
+	viewer.size = VIEWER_SIZE
+	root.add_child(viewer)
+	viewer.file_path = path
+	viewer.set("artboard", 0)
+	viewer.set("scene", 0)
+	if not viewer.get_scene():
+		viewer.set("scene", -1)
+		viewer.set("animation", 0)
+	return viewer
+
+
+## Returns the average frame time in ms, and the average upload per frame in KB.
+func _measure(path: String, property: String, value) -> Array:
+	var viewer := _make_viewer(path)
+	viewer.set(property, value)
+	for i in WARMUP_FRAMES:
+		await process_frame
+	var start := Time.get_ticks_usec()
+	var start_bytes := viewer.get_uploaded_bytes()
+	for i in FRAMES:
+		await process_frame
+	var elapsed := Time.get_ticks_usec() - start
+	var upload_kb := (viewer.get_uploaded_bytes() - start_bytes) / 1024.0 / FRAMES
+	viewer.queue_free()
+	await process_frame
+	return [elapsed / 1000.0 / FRAMES, upload_kb]
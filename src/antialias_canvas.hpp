@@ -0,0 +1,29 @@
+#ifndef _RIVEEXTENSION_ANTIALIAS_CANVAS_HPP_
+#define _RIVEEXTENSION_ANTIALIAS_CANVAS_HPP_
+
+// skia
+#include <skia/dependencies/skia/include/core/SkCanvas.h>
+#include <skia/dependencies/skia/include/core/SkPaint.h>
+#include <skia/dependencies/skia/include/core/SkPath.h>
+#include <skia/dependencies/skia/include/utils/SkPaintFilterCanvas.h>
+
+/**
+ * Forwards everything to another canvas with anti-aliasing turned off, for both paints and clip paths. The renderer
+ * draws through this instead of the surface's canvas when a viewer doesn't need smooth edges.
+ */
+class AliasedCanvas : public SkPaintFilterCanvas {
+   public:
+    AliasedCanvas(SkCanvas *canvas) : SkPaintFilterCanvas(canvas) {}
+
+   protected:
+    bool onFilter(SkPaint &paint) const override {
+        paint.setAntiAlias(false);
+        return true;
+    }
+
+    void onClipPath(const SkPath &path, SkClipOp op, ClipEdgeStyle _style) override {
+        SkPaintFilterCanvas::onClipPath(path, op, kHard_ClipEdgeStyle);
+    }
+};
+
+#endif
\ No newline at end of file
@@ -10,6 +10,7 @@
 
 // rive-cpp
 #include <rive/animation/linear_animation_instance.hpp>
+#include <rive/animation/loop.hpp>
 
 // extension
 #include "utils/types.hpp"
@@ -34,6 +35,7 @@ class RiveAnimation : public Resource {
         ClassDB::bind_method(D_METHOD("get_duration"), &RiveAnimation::get_duration);
         ClassDB::bind_method(D_METHOD("get_current_time"), &RiveAnimation::get_current_time);
         ClassDB::bind_method(D_METHOD("get_current_direction"), &RiveAnimation::get_current_direction);
+        ClassDB::bind_method(D_METHOD("is_looping"), &RiveAnimation::is_looping);
         ClassDB::bind_method(D_METHOD("reset", "speed_multiplier"), &RiveAnimation::reset);
     }
 
@@ -79,6 +81,11 @@ class RiveAnimation : public Resource {
         return animation ? animation->direction() : 1;
     }
 
+    /* Whether the animation starts over from the beginning when it ends, rather than stopping or reversing. */
+    bool is_looping() const {
+        return animation && animation->animation()->loop() == rive::Loop::loop;
+    }
+
     void reset(float speed_multiplier = 1.0) {
         if (animation) animation->reset(speed_multiplier);
     }
@@ -0,0 +1,64 @@
+#ifndef _RIVEEXTENSION_CROWD_REGISTRY_HPP_
+#define _RIVEEXTENSION_CROWD_REGISTRY_HPP_
+
+// stdlib
+#include <algorithm>
+#include <map>
+#include <vector>
+
+// godot-cpp
+#include <godot_cpp/variant/string.hpp>
+
+// extension
+#include "utils/types.hpp"
+
+using namespace godot;
+
+class RiveViewerBase;
+
+/**
+ * Groups viewers that would render exactly the same frames. One viewer leads each crowd: it's the only one that
+ * advances and rasterizes, and the others draw its texture. The leader is the first member, in joining order, that
+ * is able to lead right now, so when it leaves or stops being able to, the next one in line takes over.
+ *
+ * Only used from the main thread.
+ */
+struct CrowdRegistry {
+   private:
+    std::map<String, std::vector<RiveViewerBase *>> crowds;
+
+   public:
+    static CrowdRegistry &get() {
+        static CrowdRegistry registry;
+        return registry;
+    }
+
+    void join(const String &key, RiveViewerBase *viewer) {
+        crowds[key].push_back(viewer);
+    }
+
+    void leave(const String &key, RiveViewerBase *viewer) {
+        auto crowd = crowds.find(key);
+        if (crowd == crowds.end()) return;
+        auto &members = crowd->second;
+        members.erase(std::remove(members.begin(), members.end(), viewer), members.end());
+        if (members.empty()) crowds.erase(crowd);
+    }
+
+    /* The first member `can_lead` accepts, or the first member when none of them can. */
+    RiveViewerBase *leader(const String &key, Fn<bool, const RiveViewerBase *> can_lead) const {
+        auto crowd = crowds.find(key);
+        if (crowd == crowds.end() || crowd->second.empty()) return nullptr;
+        for (auto viewer : crowd->second)
+            if (can_lead(viewer)) return viewer;
+        return crowd->second.front();
+    }
+
+    void for_each_member(const String &key, Callback<RiveViewerBase *> fn) const {
+        auto crowd = crowds.find(key);
+        if (crowd == crowds.end()) return;
+        for (auto viewer : crowd->second) fn(viewer);
+    }
+};
+
+#endif
\ No newline at end of file
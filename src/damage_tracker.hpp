@@ -0,0 +1,223 @@
+#ifndef _RIVEEXTENSION_DAMAGE_TRACKER_HPP_
+#define _RIVEEXTENSION_DAMAGE_TRACKER_HPP_
+
+// stdlib
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+// rive-cpp
+#include <rive/artboard.hpp>
+#include <rive/drawable.hpp>
+#include <rive/math/mat2d.hpp>
+#include <rive/math/vec2d.hpp>
+#include <rive/shapes/clipping_shape.hpp>
+#include <rive/shapes/cubic_vertex.hpp>
+#include <rive/shapes/paint/gradient_stop.hpp>
+#include <rive/shapes/paint/linear_gradient.hpp>
+#include <rive/shapes/paint/shape_paint.hpp>
+#include <rive/shapes/paint/solid_color.hpp>
+#include <rive/shapes/paint/stroke.hpp>
+#include <rive/shapes/paint/trim_path.hpp>
+#include <rive/shapes/path.hpp>
+#include <rive/shapes/path_vertex.hpp>
+#include <rive/shapes/shape.hpp>
+#include <rive/shapes/straight_vertex.hpp>
+
+// skia
+#include <skia/dependencies/skia/include/core/SkRect.h>
+
+/* Extra pixels around every damaged shape, so anti-aliased edges are redrawn too. */
+static const float DAMAGE_MARGIN = 2.0;
+/* Frames a shape has to stay unchanged before it's considered static and cached in a layer. */
+static const int STATIC_FRAMES = 30;
+
+/**
+ * Finds the area of an artboard that changed since the previous frame.
+ *
+ * Every shape is summarized by a signature of its transform, geometry and paints. Shapes whose signature or bounds
+ * differ from the previous frame damage both their old and new bounds. Anything the tracker can't see inside
+ * (text, images, nested artboards, draw order changes) falls back to damaging the whole surface.
+ */
+struct DamageTracker {
+   private:
+    struct Signature {
+        uint64_t value = 14695981039346656037ull;
+
+        void add(uint32_t bits) {
+            value = (value ^ bits) * 1099511628211ull;
+        }
+
+        void add(float number) {
+            uint32_t bits;
+            memcpy(&bits, &number, sizeof(bits));
+            add(bits);
+        }
+
+        void add(const rive::Vec2D &point) {
+            add(point.x);
+            add(point.y);
+        }
+
+        void add(const rive::Mat2D &mat) {
+            for (int i = 0; i < 6; i++) add(mat[i]);
+        }
+    };
+
+    struct Entry {
+        uint64_t signature;
+        SkRect bounds;
+        int unchanged = 0;
+    };
+
+    std::unordered_map<const rive::Shape *, Entry> entries;
+    // The shape every render paint belongs to, or nullptr for the artboard's background
+    std::unordered_map<const rive::RenderPaint *, const rive::Shape *> paint_owners;
+    const rive::ArtboardInstance *last_artboard = nullptr;
+    uint64_t background = 0;
+    int background_unchanged = 0;
+    bool invalid = true;
+
+   public:
+    /* Makes the next frame redraw everything, e.g. after the surface or the layout transform changed. */
+    void invalidate() {
+        invalid = true;
+    }
+
+    /**
+     * Collects the area that changed, in surface space. Returns false when the whole surface must be redrawn,
+     * otherwise `damage` holds the changed area (which may be empty).
+     */
+    bool collect(rive::ArtboardInstance *artboard, const rive::Mat2D &transform, SkRect &damage) {
+        damage = SkRect::MakeEmpty();
+        if (!artboard) return false;
+        bool full = invalid || artboard != last_artboard || artboard->hasChangedDrawOrderInLastUpdate();
+        if (artboard != last_artboard) entries.clear();
+        paint_owners.clear();
+        last_artboard = artboard;
+        invalid = false;
+
+        Signature artboard_signature;
+        artboard_signature.add(artboard->width());
+        artboard_signature.add(artboard->height());
+        add_paints(artboard_signature, artboard);
+        if (artboard_signature.value != background) full = true;
+        background_unchanged = artboard_signature.value == background ? background_unchanged + 1 : 0;
+        background = artboard_signature.value;
+        for (auto paint : artboard->shapePaints()) paint_owners[paint->renderPaint()] = nullptr;
+
+        float scale = std::sqrt(std::abs(transform.xx() * transform.yy() - transform.xy() * transform.yx()));
+        for (auto object : artboard->objects()) {
+            if (!object || !object->is<rive::Drawable>()) continue;
+            if (!object->is<rive::Shape>()) {
+                full = true;
+                continue;
+            }
+            auto shape = object->as<rive::Shape>();
+            Entry entry = { signature(shape), bounds(shape, transform, scale) };
+            auto previous = entries.find(shape);
+            if (previous == entries.end()) damage.join(entry.bounds);
+            else if (previous->second.signature != entry.signature || previous->second.bounds != entry.bounds) {
+                damage.join(previous->second.bounds);
+                damage.join(entry.bounds);
+            }
+            if (previous != entries.end() && previous->second.signature == entry.signature)
+                entry.unchanged = previous->second.unchanged + 1;
+            entries[shape] = entry;
+            for (auto paint : shape->shapePaints()) paint_owners[paint->renderPaint()] = shape;
+        }
+        return !full;
+    }
+
+    /**
+     * The signature of the shape drawing with `paint`, if it has looked the same for the last `STATIC_FRAMES`
+     * collected frames, or 0 if it hasn't. Paints the tracker doesn't know about (images, text, nested artboards)
+     * are never static.
+     */
+    uint64_t static_signature(const rive::RenderPaint *paint) const {
+        auto owner = paint_owners.find(paint);
+        if (owner == paint_owners.end()) return 0;
+        if (!owner->second) return background_unchanged >= STATIC_FRAMES ? background : 0;
+        auto entry = entries.find(owner->second);
+        if (entry == entries.end() || entry->second.unchanged < STATIC_FRAMES) return 0;
+        return entry->second.signature;
+    }
+
+   private:
+    static uint64_t signature(rive::Shape *shape) {
+        Signature sig;
+        add_geometry(sig, shape);
+        add_paints(sig, shape);
+        // A shape also changes when the shapes clipping it do
+        for (auto clip : shape->clippingShapes()) {
+            sig.add((uint32_t)clip->isVisible());
+            for (auto clip_shape : clip->shapes()) add_geometry(sig, clip_shape);
+        }
+        return sig.value;
+    }
+
+    static void add_geometry(Signature &sig, rive::Shape *shape) {
+        sig.add(shape->worldTransform());
+        sig.add(shape->renderOpacity());
+        sig.add((uint32_t)shape->isHidden());
+        sig.add((uint32_t)shape->blendModeValue());
+        for (auto path : shape->paths()) {
+            sig.add(path->worldTransform());
+            // Handles and corner radii change the outline without moving any vertex
+            for (auto vertex : path->vertices()) {
+                sig.add(vertex->x());
+                sig.add(vertex->y());
+                if (vertex->is<rive::CubicVertex>()) {
+                    auto cubic = vertex->as<rive::CubicVertex>();
+                    sig.add(cubic->inPoint());
+                    sig.add(cubic->outPoint());
+                } else if (vertex->is<rive::StraightVertex>()) sig.add(vertex->as<rive::StraightVertex>()->radius());
+            }
+        }
+    }
+
+    static void add_paints(Signature &sig, rive::ShapePaintContainer *container) {
+        for (auto paint : container->shapePaints()) {
+            sig.add((uint32_t)paint->isVisible());
+            sig.add(paint->renderOpacity());
+            if (paint->is<rive::Stroke>()) sig.add(paint->as<rive::Stroke>()->thickness());
+            for (auto child : paint->children()) add_mutator(sig, child);
+        }
+    }
+
+    static void add_mutator(Signature &sig, rive::Component *component) {
+        if (component->is<rive::SolidColor>()) {
+            sig.add((uint32_t)component->as<rive::SolidColor>()->colorValue());
+        } else if (component->is<rive::LinearGradient>()) {
+            auto gradient = component->as<rive::LinearGradient>();
+            sig.add(gradient->startX());
+            sig.add(gradient->startY());
+            sig.add(gradient->endX());
+            sig.add(gradient->endY());
+            sig.add(gradient->opacity());
+            for (auto child : gradient->children()) {
+                if (!child->is<rive::GradientStop>()) continue;
+                auto stop = child->as<rive::GradientStop>();
+                sig.add((uint32_t)stop->colorValue());
+                sig.add(stop->position());
+            }
+        } else if (component->is<rive::TrimPath>()) {
+            auto trim = component->as<rive::TrimPath>();
+            sig.add(trim->start());
+            sig.add(trim->end());
+            sig.add(trim->offset());
+        }
+    }
+
+    static SkRect bounds(rive::Shape *shape, const rive::Mat2D &transform, float scale) {
+        float stroke = 0;
+        for (auto paint : shape->shapePaints())
+            if (paint->is<rive::Stroke>()) stroke = std::max(stroke, paint->as<rive::Stroke>()->thickness());
+        // Miter joins can reach well past half the stroke width, so pad by the full width
+        rive::AABB aabb = shape->computeWorldBounds(&transform);
+        SkRect rect = SkRect::MakeLTRB(aabb.minX, aabb.minY, aabb.maxX, aabb.maxY);
+        return rect.makeOutset(stroke * scale + DAMAGE_MARGIN, stroke * scale + DAMAGE_MARGIN);
+    }
+};
+
+#endif
\ No newline at end of file
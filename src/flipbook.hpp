@@ -0,0 +1,125 @@
+#ifndef _RIVEEXTENSION_FLIPBOOK_HPP_
+#define _RIVEEXTENSION_FLIPBOOK_HPP_
+
+// stdlib
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+// godot-cpp
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+
+// extension
+#include "utils/types.hpp"
+
+using namespace godot;
+
+/* Compressed bytes all viewers together may keep in baked frames, and the longest loop worth baking. */
+static const size_t MAX_BAKED_BYTES = 128 * 1024 * 1024;
+static const int MAX_BAKED_FRAMES = 600;
+
+/**
+ * One loop of an animation, rasterized at a fixed frame rate and kept compressed. Frames are added in order while
+ * the loop plays for the first time, and read back by index afterwards.
+ *
+ * Every flipbook draws from the same budget of `MAX_BAKED_BYTES`. A flipbook that would go over it fails and frees
+ * what it had, and stays failed until it's cleared.
+ */
+struct Flipbook {
+   private:
+    std::vector<PackedByteArray> frames;
+    PackedByteArray scratch;
+    size_t bytes = 0;
+    size_t frame_size = 0;
+    int count = 0;
+    float fps = 0;
+    bool failed = false;
+
+    static std::atomic<size_t> &baked_bytes() {
+        static std::atomic<size_t> total { 0 };
+        return total;
+    }
+
+   public:
+    ~Flipbook() {
+        clear();
+    }
+
+    /* Forgets every frame, and whether baking failed, e.g. after the size or the animation changed. */
+    void clear() {
+        baked_bytes() -= bytes;
+        frames.clear();
+        scratch = PackedByteArray();
+        bytes = 0;
+        count = 0;
+        failed = false;
+    }
+
+    /* Starts baking `duration` seconds at `frame_rate`, in frames of `size` bytes. */
+    bool begin(float duration, float frame_rate, size_t size) {
+        clear();
+        count = std::ceil(duration * frame_rate);
+        fps = frame_rate;
+        frame_size = size;
+        failed = count <= 0 || count > MAX_BAKED_FRAMES || baked_bytes() + size > MAX_BAKED_BYTES;
+        return !failed;
+    }
+
+    /* Compresses the next frame, which `write` fills in. Fails the flipbook if the budget runs out. */
+    bool add(Fn<bool, uint8_t *> write) {
+        if (!baking()) return false;
+        scratch.resize(frame_size);
+        if (!write(scratch.ptrw())) return false;
+        PackedByteArray frame = scratch.compress(FileAccess::COMPRESSION_ZSTD);
+        if (baked_bytes() + frame.size() > MAX_BAKED_BYTES) {
+            clear();
+            failed = true;
+            return false;
+        }
+        baked_bytes() += frame.size();
+        bytes += frame.size();
+        frames.push_back(frame);
+        if (complete()) scratch = PackedByteArray();
+        return true;
+    }
+
+    /* Decompresses frame `index` into `dst`, which holds `frame_size` bytes. */
+    bool read(int index, uint8_t *dst) const {
+        if (index < 0 || index >= (int)frames.size()) return false;
+        PackedByteArray frame = frames[index].decompress(frame_size, FileAccess::COMPRESSION_ZSTD);
+        if ((size_t)frame.size() != frame_size) return false;
+        memcpy(dst, frame.ptr(), frame_size);
+        return true;
+    }
+
+    /* The frame showing `time` seconds into the loop. */
+    int frame_at(float time) const {
+        if (count <= 0) return -1;
+        return std::max((int)(time * fps), 0) % count;
+    }
+
+    float duration() const {
+        return fps > 0 ? count / fps : 0;
+    }
+
+    bool is_empty() const {
+        return frames.empty();
+    }
+
+    bool has_failed() const {
+        return failed;
+    }
+
+    bool baking() const {
+        return !failed && count > 0 && (int)frames.size() < count;
+    }
+
+    bool complete() const {
+        return !failed && count > 0 && (int)frames.size() == count;
+    }
+};
+
+#endif
\ No newline at end of file
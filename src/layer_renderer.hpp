@@ -0,0 +1,84 @@
+#ifndef _RIVEEXTENSION_LAYER_RENDERER_HPP_
+#define _RIVEEXTENSION_LAYER_RENDERER_HPP_
+
+// rive-cpp
+#include <rive/renderer.hpp>
+
+// extension
+#include "utils/types.hpp"
+
+/**
+ * Splits the draw calls of a frame between two renderers. Draw calls go to `base` for as long as every one of them
+ * is static (has a non-zero static signature), and to `top` from the first one that isn't, so drawing `base` and
+ * then `top` gives the same picture as drawing the frame at once. State changes (save, restore, transforms and
+ * clips) go to both.
+ *
+ * `key` combines the signatures of what was drawn into `base`, so a layer rasterized from it can be reused while
+ * the key stays the same.
+ */
+class LayerRenderer : public rive::Renderer {
+    rive::Renderer *base;
+    rive::Renderer *top;
+    Fn<uint64_t, const rive::RenderPaint *> static_signature;
+    bool in_base = true;
+
+   public:
+    uint64_t key = 14695981039346656037ull;
+    int base_draws = 0;
+
+    LayerRenderer(
+        rive::Renderer *base, rive::Renderer *top, Fn<uint64_t, const rive::RenderPaint *> static_signature
+    )
+        : base(base), top(top), static_signature(static_signature) {}
+
+    void save() override {
+        base->save();
+        top->save();
+    }
+
+    void restore() override {
+        base->restore();
+        top->restore();
+    }
+
+    void transform(const rive::Mat2D &transform) override {
+        base->transform(transform);
+        top->transform(transform);
+    }
+
+    void clipPath(rive::RenderPath *path) override {
+        base->clipPath(path);
+        top->clipPath(path);
+    }
+
+    void drawPath(rive::RenderPath *path, rive::RenderPaint *paint) override {
+        uint64_t signature = in_base ? static_signature(paint) : 0;
+        if (signature) {
+            key = (key ^ signature) * 1099511628211ull;
+            base_draws++;
+            base->drawPath(path, paint);
+        } else {
+            in_base = false;
+            top->drawPath(path, paint);
+        }
+    }
+
+    void drawImage(const rive::RenderImage *image, rive::BlendMode mode, float opacity) override {
+        in_base = false;
+        top->drawImage(image, mode, opacity);
+    }
+
+    void drawImageMesh(
+        const rive::RenderImage *image,
+        rive::rcp<rive::RenderBuffer> vertices,
+        rive::rcp<rive::RenderBuffer> uvs,
+        rive::rcp<rive::RenderBuffer> indices,
+        rive::BlendMode mode,
+        float opacity
+    ) override {
+        in_base = false;
+        top->drawImageMesh(image, vertices, uvs, indices, mode, opacity);
+    }
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,85 @@
+#ifndef _RIVEEXTENSION_OUTPUT_MATERIAL_HPP_
+#define _RIVEEXTENSION_OUTPUT_MATERIAL_HPP_
+
+// stdlib
+#include <map>
+
+// godot-cpp
+#include <godot_cpp/classes/canvas_item.hpp>
+#include <godot_cpp/classes/ref.hpp>
+#include <godot_cpp/classes/rendering_server.hpp>
+#include <godot_cpp/classes/shader.hpp>
+#include <godot_cpp/classes/shader_material.hpp>
+#include <godot_cpp/variant/string.hpp>
+
+using namespace godot;
+
+enum OutputFlags {
+    OUTPUT_DEFAULT = 0,
+    OUTPUT_PREMULTIPLIED = 1 << 0,
+    OUTPUT_SWIZZLE = 1 << 1,
+    OUTPUT_OPAQUE = 1 << 2,
+};
+
+/**
+ * Canvas materials used to draw a viewer's texture when the pixels need more than Godot's default blending.
+ * Materials are shared between every viewer using the same flags.
+ */
+struct OutputMaterial {
+    static Ref<ShaderMaterial> get(int flags) {
+        if (flags == OUTPUT_DEFAULT) return nullptr;
+        auto &materials = cache();
+        if (materials.count(flags)) return materials.at(flags);
+        Ref<Shader> shader;
+        shader.instantiate();
+        shader->set_code(code(flags));
+        Ref<ShaderMaterial> material;
+        material.instantiate();
+        material->set_shader(shader);
+        materials[flags] = material;
+        return material;
+    }
+
+    /* Applies the material for `flags`, unless the user has assigned a material of their own. */
+    static void apply(CanvasItem *item, int flags) {
+        if (!item || item->get_material().is_valid()) return;
+        auto material = get(flags);
+        RenderingServer::get_singleton()->canvas_item_set_material(
+            item->get_canvas_item(),
+            material.is_valid() ? material->get_rid() : RID()
+        );
+    }
+
+    /* Must be called before the extension is unloaded, while the rendering server still exists. */
+    static void cleanup() {
+        cache().clear();
+    }
+
+   private:
+    static std::map<int, Ref<ShaderMaterial>> &cache() {
+        static std::map<int, Ref<ShaderMaterial>> materials;
+        return materials;
+    }
+
+    static String code(int flags) {
+        bool premultiplied = flags & OUTPUT_PREMULTIPLIED;
+        bool swizzle = flags & OUTPUT_SWIZZLE;
+        bool opaque = flags & OUTPUT_OPAQUE;
+        String code = "shader_type canvas_item;\n";
+        // Opaque frames overwrite whatever is behind them, so blending can be skipped entirely
+        if (opaque) code += "render_mode blend_disabled;\n";
+        else if (premultiplied) code += "render_mode blend_premul_alpha;\n";
+        code += "\nvarying vec4 modulate;\n\n";
+        code += "void vertex() {\n    modulate = COLOR;\n}\n\n";
+        code += "void fragment() {\n";
+        // BGRA pixels are uploaded as RGBA, so the channels are swapped back here instead of on the CPU
+        code += swizzle ? "    vec4 color = texture(TEXTURE, UV).bgra;\n" : "    vec4 color = texture(TEXTURE, UV);\n";
+        // Premultiplied pixels need the modulate alpha applied to their color channels too
+        if (premultiplied) code += "    COLOR = color * vec4(modulate.rgb * modulate.a, modulate.a);\n";
+        else code += "    COLOR = color * modulate;\n";
+        code += "}\n";
+        return code;
+    }
+};
+
+#endif
\ No newline at end of file
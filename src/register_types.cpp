@@ -6,8 +6,13 @@
 #include <godot_cpp/core/defs.hpp>
 #include <godot_cpp/godot.hpp>
 
+#include "output_material.hpp"
+#include "render_coordinator.hpp"
+#include "rive_texture.hpp"
 #include "rive_viewer.hpp"
 #include "rive_viewer_2d.hpp"
+#include "surface_pool.hpp"
+#include "texture_atlas.hpp"
 
 using namespace godot;
 
@@ -24,12 +29,19 @@ void initialize_rive_module(ModuleInitializationLevel p_level) {
     ClassDB::register_class<RiveInput>();
     ClassDB::register_class<RiveListener>();
     ClassDB::register_class<RiveAnimation>();
+    ClassDB::register_class<RiveRenderCoordinator>();
+    ClassDB::register_class<RiveTexture>();
 }
 
 void uninitialize_rive_module(ModuleInitializationLevel p_level) {
     if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE) {
         return;
     }
+
+    TextureAtlas::get().cleanup();
+    RiveRenderCoordinator::cleanup();
+    OutputMaterial::cleanup();
+    SurfacePool::get().clear();
 }
 
 extern "C" {
@@ -0,0 +1,150 @@
+#ifndef _RIVEEXTENSION_RENDER_COORDINATOR_HPP_
+#define _RIVEEXTENSION_RENDER_COORDINATOR_HPP_
+
+// stdlib
+#include <map>
+#include <mutex>
+#include <vector>
+
+// godot-cpp
+#include <godot_cpp/classes/object.hpp>
+#include <godot_cpp/classes/worker_thread_pool.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/core/memory.hpp>
+#include <godot_cpp/variant/callable.hpp>
+
+// extension
+#include "utils/types.hpp"
+
+using namespace godot;
+
+/**
+ * Collects the viewers that need a frame during process, then advances and rasterizes all of them at once on
+ * Godot's WorkerThreadPool. Each job's `finish` callback (texture uploads, signals) runs afterwards on the main
+ * thread.
+ *
+ * Jobs are flushed with a deferred call, which runs after every node has processed for the frame.
+ */
+class RiveRenderCoordinator : public Object {
+    GDCLASS(RiveRenderCoordinator, Object);
+
+   private:
+    struct Job {
+        const void *key;
+        Callback<> render;
+        Callback<> finish;
+    };
+
+    static inline RiveRenderCoordinator *singleton = nullptr;
+    static inline thread_local bool in_group = false;
+
+    std::vector<Job> queued;
+    std::vector<Job> flushing;
+    bool flush_queued = false;
+
+    std::mutex groups_mutex;
+    std::map<int64_t, Fn<void, int>> groups;
+    int64_t next_group = 0;
+
+   protected:
+    static void _bind_methods() {
+        ClassDB::bind_method(D_METHOD("_flush"), &RiveRenderCoordinator::_flush);
+        ClassDB::bind_method(D_METHOD("_run_group_item", "index", "group"), &RiveRenderCoordinator::_run_group_item);
+    }
+
+   public:
+    static RiveRenderCoordinator *get_singleton() {
+        if (!singleton) singleton = memnew(RiveRenderCoordinator);
+        return singleton;
+    }
+
+    static bool has_singleton() {
+        return singleton != nullptr;
+    }
+
+    static void cleanup() {
+        if (singleton) memdelete(singleton);
+        singleton = nullptr;
+    }
+
+    /**
+     * Queues a frame for this process step. `key` identifies the caller, so it can cancel before the flush. `render`
+     * may be empty for main-thread-only work, such as uploading the atlas once every viewer has finished.
+     *
+     * A caller has at most one job per flush: queueing again replaces its earlier job, so two jobs never render the
+     * same viewer at the same time (e.g. when both the internal and the scripted process notifications fire).
+     */
+    void enqueue(const void *key, Callback<> render, Callback<> finish) {
+        for (auto &job : queued) {
+            if (job.key != key) continue;
+            job = { key, render, finish };
+            return;
+        }
+        queued.push_back({ key, render, finish });
+        if (!flush_queued) {
+            flush_queued = true;
+            call_deferred("_flush");
+        }
+    }
+
+    /* Drops every queued job of `key`, e.g. when the viewer is freed before the flush. */
+    void cancel(const void *key) {
+        for (auto jobs : { &queued, &flushing })
+            for (auto &job : *jobs)
+                if (job.key == key) job.key = nullptr;
+    }
+
+    /**
+     * Runs `fn` for every index in [0, count) on the WorkerThreadPool and waits for all of them. Calls made from
+     * inside a pool task run serially, so nested work never waits on the pool it's running in.
+     */
+    void parallel_for(int count, Fn<void, int> fn) {
+        if (count <= 0) return;
+        if (count == 1 || in_group) {
+            for (int i = 0; i < count; i++) fn(i);
+            return;
+        }
+        int64_t group;
+        {
+            std::lock_guard<std::mutex> lock(groups_mutex);
+            group = next_group++;
+            groups[group] = fn;
+        }
+        auto pool = WorkerThreadPool::get_singleton();
+        auto task = pool->add_group_task(
+            Callable(this, "_run_group_item").bind(group),
+            count,
+            -1,
+            true,
+            "Rive rendering"
+        );
+        pool->wait_for_group_task_completion(task);
+        std::lock_guard<std::mutex> lock(groups_mutex);
+        groups.erase(group);
+    }
+
+    void _run_group_item(int index, int64_t group) {
+        Fn<void, int> fn;
+        {
+            std::lock_guard<std::mutex> lock(groups_mutex);
+            fn = groups.at(group);
+        }
+        in_group = true;
+        fn(index);
+        in_group = false;
+    }
+
+    void _flush() {
+        flush_queued = false;
+        flushing.swap(queued);
+        parallel_for(flushing.size(), [this](int i) {
+            if (flushing[i].key && flushing[i].render) flushing[i].render();
+        });
+        // `finish` may free other viewers, which cancels their remaining jobs
+        for (size_t i = 0; i < flushing.size(); i++)
+            if (flushing[i].key) flushing[i].finish();
+        flushing.clear();
+    }
+};
+
+#endif
\ No newline at end of file
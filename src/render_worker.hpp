@@ -0,0 +1,80 @@
+#ifndef _RIVEEXTENSION_RENDER_WORKER_HPP_
+#define _RIVEEXTENSION_RENDER_WORKER_HPP_
+
+// stdlib
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// extension
+#include "utils/types.hpp"
+
+/**
+ * A thread that runs one job at a time, started on first use. Used to render the next frame of a viewer while the
+ * main thread is still showing the current one.
+ */
+struct RenderWorker {
+   private:
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable condition;
+    Callback<> job;
+    bool busy = false;
+    bool quit = false;
+
+   public:
+    ~RenderWorker() {
+        stop();
+    }
+
+    /* Runs `fn` on the worker thread, waiting for the previous job to finish first. */
+    void submit(Callback<> fn) {
+        wait();
+        if (!thread.joinable()) {
+            quit = false;
+            thread = std::thread([this]() { run(); });
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        job = fn;
+        busy = true;
+        condition.notify_all();
+    }
+
+    /* Blocks until the current job, if any, has finished. */
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this]() { return !busy; });
+    }
+
+    bool is_running() const {
+        return thread.joinable();
+    }
+
+    /* Finishes the current job and shuts the thread down. */
+    void stop() {
+        if (!thread.joinable()) return;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return !busy; });
+            quit = true;
+            condition.notify_all();
+        }
+        thread.join();
+    }
+
+   private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            condition.wait(lock, [this]() { return busy || quit; });
+            if (quit) return;
+            lock.unlock();
+            job();
+            lock.lock();
+            busy = false;
+            condition.notify_all();
+        }
+    }
+};
+
+#endif
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define _RIVEEXTENSION_RIVE_INSTANCE_HPP_
 
 // Stdlib
+#include <cmath>
 #include <vector>
 
 // Godot
@@ -26,15 +27,19 @@
 
 // Extension
 #include "api/rive_file.hpp"
+#include "damage_tracker.hpp"
 #include "utils/memory.hpp"
 #include "viewer_props.hpp"
 
 struct RiveInstance {
     friend class RiveViewerBase;
+    friend class RiveTexture;
 
     ViewerProps *props;
     Ref<RiveFile> file;
     rive::Mat2D current_transform;
+    rive::Mat2D raster_transform;
+    DamageTracker damage;
 
     void set_props(ViewerProps *props_value) {
         props = props_value;
@@ -60,6 +65,30 @@ struct RiveInstance {
         return rive::Mat2D();
     }
 
+    /* Whether the artboard paints an opaque background over the whole viewer, so nothing behind it shows through. */
+    bool is_opaque() const {
+        auto ab = artboard();
+        if (!props || !exists(ab) || ab->artboard->isTranslucent()) return false;
+        // Layout transforms only scale and translate, so mapping the corners is enough
+        rive::AABB bounds = ab->artboard->bounds();
+        rive::Mat2D transform = get_transform();
+        rive::Vec2D min = transform * rive::Vec2D(bounds.minX, bounds.minY);
+        rive::Vec2D max = transform * rive::Vec2D(bounds.maxX, bounds.maxY);
+        return min.x <= 0 && min.y <= 0 && max.x >= props->width() && max.y >= props->height();
+    }
+
+    /* The part of the viewer covered by the artboard, in whole pixels. Everything outside it is letterbox. */
+    godot::Rect2i get_content_rect() const {
+        auto ab = artboard();
+        if (!props || !exists(ab)) return godot::Rect2i();
+        rive::AABB bounds = ab->artboard->bounds();
+        rive::Mat2D transform = get_transform();
+        rive::Vec2D min = transform * rive::Vec2D(bounds.minX, bounds.minY);
+        rive::Vec2D max = transform * rive::Vec2D(bounds.maxX, bounds.maxY);
+        int left = std::floor(min.x), top = std::floor(min.y);
+        return godot::Rect2i(left, top, (int)std::ceil(max.x) - left, (int)std::ceil(max.y) - top);
+    }
+
     rive::Mat2D get_inverse_transform() const {
         return get_transform().invertOrIdentity();
     }
@@ -96,6 +125,24 @@ struct RiveInstance {
         if (exists(sm)) sm->move_mouse(current_transform.invertOrIdentity(), position);
     }
 
+    /**
+     * Collects the surface area changed by the last advance. Returns false when the whole surface needs to be
+     * redrawn.
+     */
+    bool collect_damage(SkRect &area) {
+        auto ab = artboard();
+        if (!exists(ab)) return false;
+        return damage.collect(ab->artboard.get(), raster_transform, area);
+    }
+
+    /* The artboard's bounds, in artboard space. */
+    SkRect bounds() const {
+        auto ab = artboard();
+        if (!exists(ab)) return SkRect::MakeEmpty();
+        rive::AABB aabb = ab->artboard->bounds();
+        return SkRect::MakeLTRB(aabb.minX, aabb.minY, aabb.maxX, aabb.maxY);
+    }
+
     void draw(rive::Renderer *renderer) {
         auto ab = artboard();
         if (exists(ab)) ab->artboard->draw(renderer);
@@ -134,6 +181,7 @@ struct RiveInstance {
 
    private:
     void on_path_changed(godot::String path) {
+        damage.invalidate();
         if (exists(file)) unref(file);
         on_artboard_changed(-1);
         on_animation_changed(-1);
@@ -141,6 +189,7 @@ struct RiveInstance {
     }
 
     void on_artboard_changed(int index) {
+        damage.invalidate();
         if (exists(file)) file->get_artboard(index);
     }
 
@@ -166,6 +215,14 @@ struct RiveInstance {
 
     void on_transform_changed() {
         current_transform = get_transform();
+        // The surface may be smaller than the viewer, so rasterization scales the layout down to it
+        // and moves the content rectangle to its origin
+        godot::Rect2i content = props ? props->content_rect() : godot::Rect2i(0, 0, 1, 1);
+        float sx = props ? (float)props->raster_width() / content.size.x : 1;
+        float sy = props ? (float)props->raster_height() / content.size.y : 1;
+        rive::Mat2D to_surface = rive::Mat2D(sx, 0, 0, sy, -content.position.x * sx, -content.position.y * sy);
+        raster_transform = to_surface * current_transform;
+        damage.invalidate();
         if (exists(artboard())) artboard()->queue_redraw();
     }
 };
@@ -0,0 +1,243 @@
+#ifndef _RIVEEXTENSION_RIVE_TEXTURE_HPP_
+#define _RIVEEXTENSION_RIVE_TEXTURE_HPP_
+
+// godot-cpp
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/image.hpp>
+#include <godot_cpp/classes/rendering_server.hpp>
+#include <godot_cpp/classes/scene_tree.hpp>
+#include <godot_cpp/classes/texture2d.hpp>
+#include <godot_cpp/classes/window.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/templates/list.hpp>
+#include <godot_cpp/variant/callable.hpp>
+
+// extension
+#include "api/rive_file.hpp"
+#include "rive_exceptions.hpp"
+#include "rive_instance.hpp"
+#include "skia_instance.hpp"
+#include "utils/godot_macros.hpp"
+#include "viewer_props.hpp"
+
+using namespace godot;
+
+/**
+ * A texture that plays a Rive file by itself. It renders once per frame, right before the frame is drawn, and any
+ * number of sprites, materials, controls and shaders can use it at the same time.
+ *
+ * The texture keeps one RID for its whole life. Frames are uploaded into it, and a new size replaces its contents,
+ * so consumers never need to be told about a new texture.
+ */
+class RiveTexture : public Texture2D {
+    GDCLASS(RiveTexture, Texture2D);
+
+   private:
+    ViewerProps props;
+    RiveInstance inst;
+    SkiaInstance sk;
+    Ref<Image> image;
+    RID texture;
+    bool needs_redraw = true;
+    bool started = false;
+
+   protected:
+    static void _bind_methods() {
+        ADD_PROP_WITH_HINT(RiveTexture, Variant::STRING, file_path, PROPERTY_HINT_FILE, "*.riv");
+        ADD_PROP(RiveTexture, Variant::VECTOR2, size);
+        ADD_PROP_WITH_HINT(RiveTexture, Variant::INT, fit, PROPERTY_HINT_ENUM, FitEnumPropertyHint);
+        ADD_PROP_WITH_HINT(RiveTexture, Variant::INT, alignment, PROPERTY_HINT_ENUM, AlignEnumPropertyHint);
+        ADD_PROP(RiveTexture, Variant::BOOL, paused);
+        ClassDB::bind_method(D_METHOD("_on_frame_pre_draw"), &RiveTexture::_on_frame_pre_draw);
+    }
+
+    bool _set(const StringName &prop, const Variant &value) {
+        String name = prop;
+        if (name == "artboard") props.artboard((int)value);
+        else if (name == "scene") props.scene((int)value);
+        else if (name == "animation") props.animation((int)value);
+        else {
+            inst.instantiate();
+            if (!exists(inst.scene()) || !inst.scene()->get_input_names().has(name)) return false;
+            props.scene_property(name, value);
+        }
+        return true;
+    }
+
+    bool _get(const StringName &prop, Variant &return_value) const {
+        String name = prop;
+        if (name == "artboard") return_value = props.artboard();
+        else if (name == "scene") return_value = props.scene();
+        else if (name == "animation") return_value = props.animation();
+        else if (props.has_scene_property(name)) return_value = props.scene_property(name);
+        else return false;
+        return true;
+    }
+
+    void _get_property_list(List<PropertyInfo> *list) const {
+        inst.instantiate();
+        if (exists(inst.file)) {
+            String artboard_hint = inst.file->_get_artboard_property_hint();
+            list->push_back(PropertyInfo(Variant::INT, "artboard", PROPERTY_HINT_ENUM, artboard_hint));
+        }
+        auto artboard = inst.artboard();
+        if (exists(artboard)) {
+            String scene_hint = artboard->_get_scene_property_hint();
+            list->push_back(PropertyInfo(Variant::INT, "scene", PROPERTY_HINT_ENUM, scene_hint));
+            String anim_hint = artboard->_get_animation_property_hint();
+            list->push_back(PropertyInfo(Variant::INT, "animation", PROPERTY_HINT_ENUM, anim_hint));
+        }
+        auto scene = inst.scene();
+        if (exists(scene)) {
+            list->push_back(PropertyInfo(Variant::NIL, "Scene", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_CATEGORY));
+            scene->_get_input_property_list(list);
+        }
+    }
+
+   public:
+    RiveTexture() {
+        inst.set_props(&props);
+        sk.set_props(&props);
+        props.on_path_changed([this](String path) { _on_path_changed(path); });
+        props.on_transform_changed([this]() { _on_transform_changed(); });
+        props.on_artboard_changed([this](int _index) { notify_property_list_changed(); });
+        props.on_scene_changed([this](int _index) { notify_property_list_changed(); });
+        // Anything that changes the picture without advancing still needs a frame
+        props.on_scene_changed([this](int _index) { needs_redraw = true; });
+        props.on_animation_changed([this](int _index) { needs_redraw = true; });
+        props.on_scene_properties_changed([this]() { needs_redraw = true; });
+        props.size(256, 256);
+        commit();
+        RenderingServer::get_singleton()->connect("frame_pre_draw", Callable(this, "_on_frame_pre_draw"));
+    }
+
+    ~RiveTexture() {
+        // The frame_pre_draw connection goes away with the object
+        auto server = RenderingServer::get_singleton();
+        if (server && texture.is_valid()) server->free_rid(texture);
+    }
+
+    /**
+     * Advances the scene and uploads what changed. Runs once per frame, before anything draws the texture. Time
+     * starts on the first frame drawn, and follows the scene tree's process step.
+     */
+    void _on_frame_pre_draw() {
+        commit();
+        float delta = started ? process_delta() : 0;
+        started = true;
+        if (props.paused() || !exists(inst.file) || !exists(inst.artboard()) || !sk.surface || image.is_null()) return;
+        if (!inst.advance(delta) && !needs_redraw) return;
+        needs_redraw = false;
+        SkRect changed;
+        SkIRect damage = inst.collect_damage(changed) ? changed.roundOut() : sk.bounds();
+        if (!damage.intersect(sk.bounds())) return;
+        sk.record(inst.bounds(), [this](rive::Renderer *renderer) { inst.draw(renderer); });
+        if (!sk.replay(damage, inst.raster_transform) || !sk.copy_to(image->ptrw(), damage)) return;
+        RenderingServer::get_singleton()->texture_2d_update(texture, image, 0);
+    }
+
+    /* Texture2D */
+
+    int32_t _get_width() const override {
+        return props.width();
+    }
+
+    int32_t _get_height() const override {
+        return props.height();
+    }
+
+    bool _has_alpha() const override {
+        return !sk.opaque();
+    }
+
+    RID _get_rid() const override {
+        return texture;
+    }
+
+    /* Setters */
+
+    void set_file_path(String value) {
+        props.path(value);
+    }
+
+    void set_size(Vector2 value) {
+        props.size(value.x, value.y);
+    }
+
+    void set_fit(int value) {
+        props.fit((FIT)value);
+    }
+
+    void set_alignment(int value) {
+        props.alignment((ALIGN)value);
+    }
+
+    void set_paused(bool value) {
+        props.paused(value);
+    }
+
+    /* Getters */
+
+    String get_file_path() const {
+        return props.path();
+    }
+
+    Vector2 get_size() const {
+        return props.size();
+    }
+
+    int get_fit() const {
+        return props.fit();
+    }
+
+    int get_alignment() const {
+        return props.alignment();
+    }
+
+    bool get_paused() const {
+        return props.paused();
+    }
+
+   private:
+    /* The scene tree's process step, which follows `Engine.time_scale`. Nothing advances while the tree is paused. */
+    static float process_delta() {
+        auto tree = Object::cast_to<SceneTree>(Engine::get_singleton()->get_main_loop());
+        if (!tree || tree->is_paused() || !tree->get_root()) return 0;
+        return tree->get_root()->get_process_delta_time();
+    }
+
+    void commit() {
+        if (!props.is_dirty()) return;
+        // Consumers sample the whole texture, so it covers the letterbox too, rather than only the artboard
+        props.content_rect(Rect2i(0, 0, props.width(), props.height()));
+        props.commit();
+    }
+
+    void _on_path_changed(String path) {
+        try {
+            inst.file = RiveFile::Load(path, sk.factory.get());
+        } catch (RiveException error) {
+            error.report();
+        }
+        needs_redraw = true;
+        notify_property_list_changed();
+    }
+
+    /**
+     * Runs after the surface was rebuilt. A new size gets a new image, whose texture takes the place of the old
+     * one under the same RID.
+     */
+    void _on_transform_changed() {
+        needs_redraw = true;
+        if (!sk.surface) return;
+        if (image.is_valid() && image->get_width() == sk.width() && image->get_height() == sk.height()) return;
+        image = Image::create(sk.width(), sk.height(), false, sk.image_format());
+        auto server = RenderingServer::get_singleton();
+        RID replacement = server->texture_2d_create(image);
+        if (texture.is_valid()) server->texture_replace(texture, replacement);
+        else texture = replacement;
+        emit_changed();
+    }
+};
+
+#endif
\ No newline at end of file
@@ -1,8 +1,11 @@
 #include "rive_viewer_base.h"
 
 #include <algorithm>
+#include <chrono>
+#include <cmath>
 
 // godot-cpp
+#include <godot_cpp/classes/class_db_singleton.hpp>
 #include <godot_cpp/classes/engine.hpp>
 #include <godot_cpp/classes/rendering_device.hpp>
 #include <godot_cpp/classes/rendering_server.hpp>
@@ -18,7 +21,22 @@
 #include "utils/godot_macros.hpp"
 #include "utils/types.hpp"
 
-const Image::Format IMAGE_FORMAT = Image::Format::FORMAT_RGBA8;
+/* How much the automatic render scale changes in one step, and how many frames it waits between steps. */
+const float AUTO_SCALE_STEP = 0.85;
+const int AUTO_SCALE_INTERVAL = 30;
+
+/* The on-screen scale has to move this far from the current level of detail before the surface is resized. */
+const float LOD_HYSTERESIS = 1.25;
+
+/**
+ * In automatic anti-aliasing, the fewest surface pixels per on-screen pixel, and the smallest on-screen side in
+ * pixels, that are still drawn with AA.
+ */
+const float AUTO_AA_RATIO = 0.75;
+const float AUTO_AA_MIN_SIZE = 64;
+
+/* Weight of the newest sample in the raster time average. */
+const float RASTER_TIME_WEIGHT = 0.1;
 
 RiveViewerBase::RiveViewerBase(CanvasItem *owner) {
     this->owner = owner;
@@ -30,44 +48,307 @@ RiveViewerBase::RiveViewerBase(CanvasItem *owner) {
     props.on_path_changed([this](String path) { _on_path_changed(path); });
     props.on_size_changed([this](float w, float h) { _on_size_changed(w, h); });
     props.on_transform_changed([this]() { _on_transform_changed(); });
+    // Anything that can change what's on screen wakes a settled viewer
+    props.on_path_changed([this](String _path) { wake(); });
+    props.on_artboard_changed([this](int _index) { wake(); });
+    props.on_scene_changed([this](int _index) { wake(); });
+    props.on_animation_changed([this](int _index) { wake(); });
+    props.on_scene_properties_changed([this]() { wake(); });
+    props.on_transform_changed([this]() { wake(); });
+    props.on_dirty([this]() { wake(); });
+    // Recordings belong to one artboard
+    props.on_path_changed([this](String _path) { sk.picture = nullptr; });
+    props.on_artboard_changed([this](int _index) { sk.picture = nullptr; });
+    // Baked frames belong to one animation
+    props.on_path_changed([this](String _path) { flipbook.clear(); });
+    props.on_artboard_changed([this](int _index) { flipbook.clear(); });
+    props.on_scene_changed([this](int _index) { flipbook.clear(); });
+    props.on_animation_changed([this](int _index) { flipbook.clear(); });
+    // Anything that's part of the crowd key can move the viewer to another crowd
+    props.on_path_changed([this](String _path) { update_crowd(); });
+    props.on_artboard_changed([this](int _index) { update_crowd(); });
+    props.on_scene_changed([this](int _index) { update_crowd(); });
+    props.on_animation_changed([this](int _index) { update_crowd(); });
+    props.on_scene_properties_changed([this]() { update_crowd(); });
+    props.on_transform_changed([this]() { update_crowd(); });
+}
+
+RiveViewerBase::~RiveViewerBase() {
+    worker.stop();
+    if (RiveRenderCoordinator::has_singleton()) RiveRenderCoordinator::get_singleton()->cancel(this);
+    TextureAtlas::get().release(atlas_slot);
+    if (!crowd_key.is_empty()) {
+        // Followers were drawing this viewer's texture, and the next one in line leads from now on
+        CrowdRegistry::get().leave(crowd_key, this);
+        wake_crowd(crowd_key);
+    }
 }
 
 void RiveViewerBase::on_input_event(const Ref<InputEvent> &event) {
     auto mouse_event = dynamic_cast<InputEventMouse *>(event.ptr());
     if (!mouse_event || is_editor_hint()) return;
+    if (owner->is_node_ready()) commit();  // Hit testing needs the current layout
 
     Vector2 pos = mouse_event->get_position();
 
     if (auto mouse_button = dynamic_cast<InputEventMouseButton *>(event.ptr())) {
         if (!props.disable_press() && mouse_button->is_pressed()) {
-            inst.press_mouse(pos);
+            press_mouse(pos);
             owner->emit_signal("pressed", mouse_event->get_position());
         } else if (!props.disable_press() && mouse_button->is_released()) {
-            inst.release_mouse(pos);
+            release_mouse(pos);
             owner->emit_signal("released", mouse_event->get_position());
         }
     }
     if (auto mouse_motion = dynamic_cast<InputEventMouseMotion *>(event.ptr())) {
-        if (!props.disable_hover()) inst.move_mouse(pos);
+        if (!props.disable_hover()) move_mouse(pos);
     }
 }
 
 void RiveViewerBase::on_draw() {
-    if (!is_null(texture)) owner->draw_texture_rect(texture, Rect2(0, 0, width(), height()), false);
+    drawn_flags = output_flags();
+    OutputMaterial::apply(owner, drawn_flags);
+    // The texture only covers the artboard, so it's placed at the artboard's offset and the letterbox stays empty
+    Rect2i content = props.content_rect();
+    frame_source()->draw_frame(owner, Rect2(content.position, content.size));
+}
+
+/* Draws this viewer's current frame into `target`, which is either its owner or a follower in its crowd. */
+void RiveViewerBase::draw_frame(CanvasItem *target, const Rect2 &rect) {
+    if (props.virtual_tiles()) {
+        // Tiles are in raster space: the content rectangle, scaled by the raster scale
+        float scale = props.raster_scale();
+        SkIRect bounds = raster_bounds();
+        tiles.for_each([&](const SkIRect &tile_rect, TileGrid::Tile &tile) {
+            SkIRect visible = tile_rect;
+            if (tile.texture.is_null() || !visible.intersect(bounds)) return;
+            Rect2 src = Rect2(0, 0, visible.width(), visible.height());
+            Vector2 offset = Vector2(visible.left(), visible.top()) / scale;
+            target->draw_texture_rect_region(tile.texture, Rect2(rect.position + offset, src.size / scale), src);
+        });
+        return;
+    }
+    if (atlas_slot.valid()) {
+        auto page = TextureAtlas::get().get_texture(atlas_slot);
+        SkIRect region = atlas_slot.rect;
+        Rect2 src = Rect2(region.left(), region.top(), region.width(), region.height());
+        if (!is_null(page)) target->draw_texture_rect_region(page, rect, src);
+        return;
+    }
+    auto texture = textures.get_texture();
+    if (!is_null(texture)) target->draw_texture_rect(texture, rect, false);
+}
+
+int RiveViewerBase::output_flags() const {
+    const RiveViewerBase *source = frame_source();
+    int flags = OUTPUT_DEFAULT;
+    if (props.premultiplied_alpha()) flags |= OUTPUT_PREMULTIPLIED;
+    if (source->sk.swizzled()) flags |= OUTPUT_SWIZZLE;
+    // A settled viewer can't notice a parent fading it out, so only running viewers skip blending
+    if (source->sk.opaque() && !source->sleeping && is_modulate_opaque()) flags |= OUTPUT_OPAQUE;
+    return flags;
+}
+
+/* Whether the viewer is drawn at full opacity, including the modulate inherited from its parents. */
+bool RiveViewerBase::is_modulate_opaque() const {
+    if (owner->get_self_modulate().a < 1) return false;
+    for (CanvasItem *item = owner; item; item = item->get_parent_item())
+        if (item->get_modulate().a < 1) return false;
+    return true;
 }
 
 void RiveViewerBase::on_process(float delta) {
-    if (owner->is_node_ready() && !props.paused()) {
-        if (is_null(image)) image = Image::create(width(), height(), false, IMAGE_FORMAT);
-        if (is_null(texture)) texture = ImageTexture::create_from_image(image);
-        PackedByteArray bytes = frame(delta);
-        if (bytes.size()) {
-            image->set_data(width(), height(), false, IMAGE_FORMAT, bytes);
-            texture->update(image);
-            owner->queue_redraw();
+    if (!owner->is_node_ready()) return;
+    commit();
+    // Followers draw their leader's frame, so there's nothing for them to advance or rasterize
+    if (frame_source() != this) {
+        following = true;
+        return;
+    }
+    if (following) {
+        // What's on the surface is from before this viewer followed another one
+        following = false;
+        inst.damage.invalidate();
+        textures.clear();
+    }
+    if (props.paused()) return;
+    // With a frame rate cap, time accumulates and is applied in one step once the interval has passed. The phase
+    // keeps what's left past the interval, so steps stay on the cap's schedule instead of drifting below it. A new
+    // layout is drawn right away if it's on screen, rather than showing an empty surface until then.
+    bool visible = owner->is_visible();
+    pending_delta += delta;
+    if (props.max_fps() > 0) {
+        double interval = 1.0 / props.max_fps();
+        frame_phase += delta;
+        if (frame_phase < interval && !(invalidated && visible)) return;
+        frame_phase = std::fmod(frame_phase, interval);
+    }
+    delta = pending_delta;
+    pending_delta = 0;
+    switch (props.threading()) {
+        case THREADING::PIPELINED:
+            // Show the frame the worker just finished, then render the next one while this one is on screen
+            worker.wait();
+            finish_frame();
+            if (!sleeping) worker.submit([this, delta, visible]() { rendered = render(delta, visible); });
+            break;
+        case THREADING::PARALLEL:
+            RiveRenderCoordinator::get_singleton()->enqueue(
+                this,
+                [this, delta, visible]() { rendered = render(delta, visible); },
+                [this]() { finish_frame(); }
+            );
+            break;
+        case THREADING::MAIN:
+        default:
+            if (render(delta, visible)) rendered = true;
+            finish_frame();
+            break;
+    }
+}
+
+/* Uploads the last rendered frame and reports what changed. Always runs on the main thread. */
+void RiveViewerBase::finish_frame() {
+    if (rendered) present();
+    rendered = false;
+    props.opaque(inst.is_opaque());
+    if (output_flags() != drawn_flags) owner->queue_redraw();
+    update_render_scale();
+    update_lod();
+    update_visible_tiles();
+    update_antialias();
+    check_scene_property_changed();
+    // A hidden viewer keeps its pending full frame for when it's shown, but doesn't stay awake for it
+    if (props.auto_sleep() && !changing && !(invalidated && owner->is_visible())) sleep();
+}
+
+/**
+ * Lowers the raster resolution while rasterizing takes longer than the frame budget, and raises it again once the
+ * larger surface is expected to fit comfortably. Raster cost grows with the area, so the estimate is squared.
+ */
+void RiveViewerBase::update_render_scale() {
+    float budget = props.frame_budget();
+    if (budget <= 0 || raster_time <= 0 || ++frames_since_rescale < AUTO_SCALE_INTERVAL) return;
+    float scale = props.auto_scale();
+    float next = scale;
+    float larger_time = raster_time / (AUTO_SCALE_STEP * AUTO_SCALE_STEP);
+    if (raster_time > budget) next = std::max(scale * AUTO_SCALE_STEP, MIN_RENDER_SCALE);
+    else if (larger_time < budget * 0.8) next = std::min(scale / AUTO_SCALE_STEP, 1.0f);
+    if (next == scale) return;
+    raster_time *= (next * next) / (scale * scale);
+    frames_since_rescale = 0;
+    props.auto_scale(next);
+}
+
+/**
+ * Follows the scale the viewer is shown at on screen, including parent transforms and the camera zoom. Levels are
+ * snapped to half powers of two and only change once the scale leaves a band around the current one, so a zoom
+ * animation reallocates a handful of times instead of every frame. Virtualized viewers follow it even without
+ * `auto_lod`.
+ */
+void RiveViewerBase::update_lod() {
+    if (!props.auto_lod() && !props.virtual_tiles()) return;
+    Size2 on_screen = owner->get_global_transform_with_canvas().get_scale().abs();
+    float scale = std::max(on_screen.x, on_screen.y);
+    float current = props.lod_scale();
+    if (scale <= 0 || (scale < current * LOD_HYSTERESIS && scale > current / LOD_HYSTERESIS)) return;
+    float level = std::pow(2.0f, std::round(std::log2(scale) * 2) / 2);
+    props.lod_scale(std::clamp(level, MIN_RENDER_SCALE, MAX_LOD_SCALE));
+}
+
+/**
+ * Automatic anti-aliasing stays on while the surface has about as many pixels as the viewer covers on screen. When
+ * it's rendered smaller and upscaled, the bilinear filtering in on_draw already softens every edge, and viewers that
+ * are small on screen have too few pixels for it to show.
+ */
+bool RiveViewerBase::wants_antialias() const {
+    switch (props.antialiasing()) {
+        case ANTIALIASING::AA_OFF:
+            return false;
+        case ANTIALIASING::AA_AUTO: {
+            Size2 on_screen = owner->get_global_transform_with_canvas().get_scale().abs();
+            Size2 screen_size = props.size() * on_screen;
+            if (std::min(screen_size.x, screen_size.y) < AUTO_AA_MIN_SIZE) return false;
+            return props.raster_scale() >= std::max(on_screen.x, on_screen.y) * AUTO_AA_RATIO;
         }
-        check_scene_property_changed();
+        case ANTIALIASING::AA_ON:
+        default:
+            return true;
+    }
+}
+
+/**
+ * Applies the anti-aliasing setting that's in effect. A switch redraws the whole surface, since the damage tracker
+ * would otherwise only redraw what moved and leave AA and aliased pixels side by side.
+ */
+void RiveViewerBase::update_antialias() {
+    if (!sk.set_antialias(wants_antialias())) return;
+    inst.damage.invalidate();
+    tiles.invalidate();
+    flipbook.clear();
+    invalidated = true;
+    wake();
+}
+
+/**
+ * Works out which tiles of a virtualized viewer are around the viewport. Runs on the main thread between renders,
+ * so the render that follows only ever sees a stable set of tiles.
+ */
+void RiveViewerBase::update_visible_tiles() {
+    if (!props.virtual_tiles()) return;
+    Rect2 view = owner->get_global_transform_with_canvas().affine_inverse().xform(owner->get_viewport_rect());
+    Vector2 origin = Vector2(props.content_rect().position);
+    Vector2 start = (view.position - origin) * props.raster_scale() / VIRTUAL_TILE_SIZE;
+    Vector2 end = (view.get_end() - origin) * props.raster_scale() / VIRTUAL_TILE_SIZE;
+    SkIRect visible = SkIRect::MakeLTRB(std::floor(start.x), std::floor(start.y), std::ceil(end.x), std::ceil(end.y));
+    int columns = (props.raster_width() + VIRTUAL_TILE_SIZE - 1) / VIRTUAL_TILE_SIZE;
+    int rows = (props.raster_height() + VIRTUAL_TILE_SIZE - 1) / VIRTUAL_TILE_SIZE;
+    tiles.set_range(visible, SkIRect::MakeWH(columns, rows), sk.image_format());
+}
+
+void RiveViewerBase::sleep() {
+    // A settled virtualized viewer would stop following the viewport
+    if (sleeping || props.virtual_tiles()) return;
+    sleeping = true;
+    owner->set_process_internal(false);
+    if (drawn_flags & OUTPUT_OPAQUE) owner->queue_redraw();
+    owner->emit_signal("settled");
+}
+
+void RiveViewerBase::sync() const {
+    worker.wait();
+}
+
+/* Applies the property changes made since the last frame, before anything is rendered with them. */
+void RiveViewerBase::commit() {
+    if (!props.is_dirty()) return;
+    sync();
+    props.content_rect(inst.get_content_rect());
+    update_antialias();
+    props.commit();
+}
+
+void RiveViewerBase::queue_input(Callback<> input) {
+    wake();
+    if (props.threading() == THREADING::PIPELINED && worker.is_running()) {
+        std::lock_guard<std::mutex> lock(input_mutex);
+        queued_inputs.push_back(input);
+    } else input();
+}
+
+void RiveViewerBase::apply_queued_inputs() {
+    std::vector<Callback<>> inputs;
+    {
+        std::lock_guard<std::mutex> lock(input_mutex);
+        inputs.swap(queued_inputs);
     }
+    for (auto &input : inputs) input();
+}
+
+void RiveViewerBase::wake() {
+    if (!sleeping) return;
+    sleeping = false;
+    owner->set_process_internal(true);
 }
 
 void RiveViewerBase::on_ready() {
@@ -110,6 +391,7 @@ void RiveViewerBase::_on_path_changed(String path) {
 }
 
 void RiveViewerBase::get_property_list(List<PropertyInfo> *list) const {
+    sync();
     if (owner->is_node_ready()) {
         inst.instantiate();
         if (exists(inst.file)) {
@@ -154,17 +436,24 @@ void RiveViewerBase::_on_animation_changed(int _index) {
 bool RiveViewerBase::on_set(const StringName &prop, const Variant &value) {
     String name = prop;
     if (name == "artboard") {
+        sync();
         props.artboard((int)value);
         return true;
     }
     if (name == "scene") {
+        sync();
         props.scene((int)value);
         return true;
     }
     if (name == "animation") {
+        sync();
         props.animation((int)value);
         return true;
     }
+    // Every property set on the node passes through here first, so its own properties (position, modulate, ...)
+    // go back to Godot without waiting for the worker
+    if (ClassDBSingleton::get_singleton()->class_has_property(owner->get_class(), name)) return false;
+    sync();
     inst.instantiate();
     if (exists(inst.scene()) && inst.scene()->get_input_names().has(name)) {
         props.scene_property(name, value);
@@ -195,64 +484,308 @@ bool RiveViewerBase::on_get(const StringName &prop, Variant &return_value) const
 }
 
 void RiveViewerBase::_on_size_changed(float w, float h) {
-    if (!is_null(image)) unref(image);
-    if (!is_null(texture)) unref(texture);
-    image = Image::create(width(), height(), false, IMAGE_FORMAT);
-    texture = ImageTexture::create_from_image(image);
+    textures.clear();
+    tiles.clear();
+    // Runs before the surface is rebuilt, so the new surface already points at the new slot
+    auto &atlas = TextureAtlas::get();
+    bool premultiplied = props.premultiplied_alpha();
+    int raster_w = props.raster_width(), raster_h = props.raster_height();
+    bool keep = use_atlas() ? atlas_slot.matches(raster_w, raster_h, premultiplied) : !atlas_slot.valid();
+    if (keep) return;
+    atlas.release(atlas_slot);
+    if (use_atlas()) atlas_slot = atlas.allocate(raster_w, raster_h, premultiplied);
+    sk.use_pixels(atlas.pixels(atlas_slot), atlas.row_bytes());
+}
+
+/**
+ * Small viewers can share an atlas page. Pipelined viewers keep their own surface, since their worker would still be
+ * writing into the page while the main thread uploads it. Pages are RGBA8, so the 16 and 8 bit formats opt out too.
+ */
+bool RiveViewerBase::use_atlas() const {
+    bool full_color = props.pixel_format() == PIXEL_FORMAT::RGBA8 || props.pixel_format() == PIXEL_FORMAT::NATIVE;
+    return props.atlas() && full_color && props.threading() != THREADING::PIPELINED && !props.virtual_tiles()
+        && TextureAtlas::fits(props.raster_width(), props.raster_height());
 }
 
 void RiveViewerBase::_on_transform_changed() {
-    if (sk.renderer) sk.renderer->transform(inst.current_transform);
-    PackedByteArray bytes = frame(0.0);
-    if (bytes.size()) {
-        image->set_data(width(), height(), false, IMAGE_FORMAT, bytes);
-        texture->update(image);
-        owner->queue_redraw();
+    // Baked frames are only good for the size and layout they were rasterized at
+    flipbook.clear();
+    if (props.virtual_tiles()) {
+        update_visible_tiles();
+        tiles.invalidate();
     }
+    // The damage tracker starts over with the new layout, so the next render draws the whole surface. Sleeping
+    // viewers are woken by the same change.
+    if (!props.paused()) {
+        invalidated = true;
+        return;
+    }
+    // Paused viewers don't render, so the last recorded frame is rasterized again at the new size and layout
+    auto redraw_current = [this]() {
+        inst.advance(0.0);
+        return redraw();
+    };
+    if (props.virtual_tiles()) {
+        if ((sk.picture && rasterize_tiles(SkIRect::MakeEmpty())) || redraw_current()) present();
+    } else if (rasterize(sk.bounds())) {
+        damage = sk.bounds();
+        present();
+    } else if (redraw_current()) present();
 }
 
 bool RiveViewerBase::advance(float delta) {
     elapsed += delta;
-    return inst.advance(delta);
+    changing = inst.advance(delta);
+    return changing;
 }
 
-PackedByteArray RiveViewerBase::redraw() {
+bool RiveViewerBase::redraw() {
     auto artboard = inst.artboard();
-    if (sk.surface && sk.renderer && exists(artboard)) {
-        sk.clear();
-        inst.draw(sk.renderer.get());
-        return sk.bytes();
+    if (!sk.surface || !sk.renderer || !exists(artboard)) return false;
+    SkRect changed;
+    SkIRect bounds = raster_bounds();
+    damage = inst.collect_damage(changed) ? changed.roundOut() : bounds;
+    if (!damage.intersect(bounds)) return props.virtual_tiles() && rasterize_tiles(SkIRect::MakeEmpty());
+    auto start = std::chrono::steady_clock::now();
+    auto draw = [this](rive::Renderer *renderer) { inst.draw(renderer); };
+    // Tiles are each rasterized with their own transform, so they can't share a layer
+    if (props.layer_cache() && !props.virtual_tiles())
+        sk.record(inst.bounds(), draw, [this](const rive::RenderPaint *paint) {
+            return inst.damage.static_signature(paint);
+        });
+    else sk.record(inst.bounds(), draw);
+    if (props.virtual_tiles()) rasterize_tiles(damage);
+    else rasterize(damage);
+    float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    raster_time = raster_time > 0 ? raster_time + (ms - raster_time) * RASTER_TIME_WEIGHT : ms;
+    return true;
+}
+
+/* Rasterizes the recorded frame into `area`, split into bands across the WorkerThreadPool in tiled mode. */
+bool RiveViewerBase::rasterize(const SkIRect &area) {
+    if (!props.tiled()) return sk.replay(area, inst.raster_transform);
+    return sk.replay_tiled(area, inst.raster_transform, [](int count, Fn<void, int> fn) {
+        RiveRenderCoordinator::get_singleton()->parallel_for(count, fn);
+    });
+}
+
+bool RiveViewerBase::frame(float delta) {
+    return render(delta, owner->is_visible());
+}
+
+/* Advances and rasterizes a frame. Runs on the render worker in pipelined mode, so it must not touch the owner. */
+bool RiveViewerBase::render(float delta, bool visible) {
+    apply_queued_inputs();
+    if (!exists(inst.file) || !exists(inst.artboard()) || !sk.renderer || !sk.surface) return false;
+    if (wants_bake()) return render_baked(delta, visible);
+    bool advanced = advance(delta);
+    if (!visible) return false;
+    if (advanced || (invalidated && !sk.picture)) {
+        invalidated = false;
+        return redraw();
     }
-    return PackedByteArray();
+    if (invalidated) {
+        // Only the size, layout or anti-aliasing changed, so the last recording is rasterized again in full
+        invalidated = false;
+        damage = raster_bounds();
+        if (props.virtual_tiles()) return rasterize_tiles(SkIRect::MakeEmpty());
+        return rasterize(damage);
+    }
+    // Tiles that scrolled into view still need the current frame, even when nothing moved
+    if (props.virtual_tiles() && sk.picture) return rasterize_tiles(SkIRect::MakeEmpty());
+    return false;
 }
 
-PackedByteArray RiveViewerBase::frame(float delta) {
-    if (!exists(inst.file) || !exists(inst.artboard()) || !sk.renderer || !sk.surface) return PackedByteArray();
-    if (advance(delta) && owner->is_visible()) return redraw();
-    return PackedByteArray();
+/**
+ * Baking needs a looping animation with no state machine, which always looks the same at the same point of its
+ * loop, and a surface that holds the whole frame.
+ */
+bool RiveViewerBase::wants_bake() const {
+    if (props.bake_fps() <= 0 || flipbook.has_failed() || props.virtual_tiles() || atlas_slot.valid()) return false;
+    auto anim = inst.animation();
+    return !exists(inst.scene()) && exists(anim) && anim->is_looping();
+}
+
+/**
+ * Plays a baked loop. The first time around, the loop is advanced at the bake frame rate, one frame per tick at
+ * most, and every frame is compressed into the flipbook as it's rasterized. From then on, frames are only looked up
+ * by time: the animation isn't advanced and nothing is rasterized.
+ */
+bool RiveViewerBase::render_baked(float delta, bool visible) {
+    elapsed += delta;
+    changing = true;
+    if (flipbook.complete()) {
+        bake_time = std::fmod(bake_time + delta, flipbook.duration());
+        int index = flipbook.frame_at(bake_time);
+        if (index == baked_frame || !visible) return false;
+        baked_frame = index;
+        damage = sk.bounds();
+        invalidated = false;
+        return true;
+    }
+    float step = 1.0f / props.bake_fps();
+    bool first = !flipbook.baking();
+    if (first) {
+        auto anim = inst.animation();
+        size_t frame_size = sk.output_info().computeMinByteSize();
+        if (!flipbook.begin(anim->get_duration(), props.bake_fps(), frame_size)) return false;
+        anim->reset();
+        bake_time = 0;
+        bake_pending = 0;
+        baked_frame = -1;
+    } else {
+        bake_pending += delta;
+        if (bake_pending < step) return false;
+        bake_pending = std::min(bake_pending - step, step);
+        bake_time += step;
+    }
+    inst.advance(first ? 0 : step);
+    redraw();
+    flipbook.add([this](uint8_t *dst) { return sk.copy_to(dst); });
+    invalidated = false;
+    return true;
+}
+
+/* The whole area the artboard is rasterized to. Larger than the surface when the viewer is virtualized. */
+SkIRect RiveViewerBase::raster_bounds() const {
+    if (props.virtual_tiles()) return SkIRect::MakeWH(props.raster_width(), props.raster_height());
+    return sk.bounds();
+}
+
+/**
+ * Rasterizes the recorded frame into the tiles around the viewport, one tile at a time through the surface. Tiles
+ * that were rasterized before only redraw `area`; new ones are drawn in full.
+ */
+bool RiveViewerBase::rasterize_tiles(const SkIRect &area) {
+    bool changed = false;
+    tiles.for_each([&](const SkIRect &tile_rect, TileGrid::Tile &tile) {
+        SkIRect tile_area = tile.rasterized ? area : tile_rect;
+        if (!tile_area.intersect(tile_rect)) return;
+        tile_area.offset(-tile_rect.left(), -tile_rect.top());
+        rive::Mat2D to_tile = rive::Mat2D(1, 0, 0, 1, -tile_rect.left(), -tile_rect.top()) * inst.raster_transform;
+        if (!sk.replay(tile_area, to_tile) || !sk.copy_to(tile.image->ptrw(), tile_area)) return;
+        tile.rasterized = tile.dirty = changed = true;
+    });
+    return changed;
+}
+
+/* Hands the damaged area of the surface to Godot, through the tiles, the atlas page or the viewer's textures. */
+void RiveViewerBase::present() {
+    if (props.virtual_tiles()) {
+        if (tiles.upload()) owner->queue_redraw();
+    } else if (atlas_slot.valid()) {
+        TextureAtlas::get().mark_dirty(atlas_slot, damage);
+        owner->queue_redraw();
+    } else upload();
+    CrowdRegistry::get().for_each_member(crowd_key, [this](RiveViewerBase *viewer) {
+        if (viewer != this) viewer->owner->queue_redraw();
+    });
+}
+
+/**
+ * Viewers showing the same file, artboard, scene or animation and inputs, at the same size, layout and frame rate,
+ * render the same frames, and paused viewers only match other paused ones. Only viewers that opt in with a share
+ * group are keyed; the group also tells apart viewers that play the same animation at different phases.
+ */
+String RiveViewerBase::get_crowd_key() const {
+    if (props.share_group() < 0 || props.virtual_tiles() || props.path().is_empty()) return "";
+    std::vector<int64_t> values = {
+        props.artboard(), props.scene(), props.animation(), props.fit(), props.alignment(), props.width(),
+        props.height(), props.pixel_format(), props.premultiplied_alpha(), props.paused(), props.max_fps(),
+        props.scene_properties().hash(), props.share_group()
+    };
+    String key = props.path();
+    for (int64_t value : values) key += "|" + String::num_int64(value);
+    return key;
+}
+
+void RiveViewerBase::update_crowd() {
+    String key = get_crowd_key();
+    if (key == crowd_key) return;
+    auto &crowds = CrowdRegistry::get();
+    if (!crowd_key.is_empty()) {
+        crowds.leave(crowd_key, this);
+        wake_crowd(crowd_key);
+    }
+    crowd_key = key;
+    if (!crowd_key.is_empty()) crowds.join(crowd_key, this);
+    wake();
+    owner->queue_redraw();
+}
+
+/**
+ * A viewer can only lead while it's processing and drawn: a hidden viewer advances without rasterizing, and one
+ * outside the tree doesn't process at all, so its followers would freeze.
+ */
+bool RiveViewerBase::can_lead() const {
+    return owner->is_inside_tree() && owner->is_visible_in_tree();
+}
+
+/* Wakes and redraws every member of a crowd whose leader may have changed. */
+void RiveViewerBase::wake_crowd(const String &key) {
+    CrowdRegistry::get().for_each_member(key, [](RiveViewerBase *viewer) {
+        viewer->wake();
+        viewer->owner->queue_redraw();
+    });
+}
+
+/* The viewer whose frame this one shows. Elected every time, so leadership follows visibility and tree changes. */
+RiveViewerBase *RiveViewerBase::frame_source() {
+    if (crowd_key.is_empty()) return this;
+    auto leader = CrowdRegistry::get().leader(crowd_key, [](const RiveViewerBase *viewer) {
+        return viewer->can_lead();
+    });
+    return leader ? leader : this;
+}
+
+const RiveViewerBase *RiveViewerBase::frame_source() const {
+    return const_cast<RiveViewerBase *>(this)->frame_source();
+}
+
+void RiveViewerBase::upload() {
+    textures.resize(props.buffer_count(), sk.width(), sk.height(), sk.image_format());
+    textures.damage(damage);
+    // Only the damaged rows are copied into the image's own storage. Godot 4 has no partial texture update, so
+    // the texture itself is still updated as a whole.
+    bool uploaded = textures.present([this](uint8_t *dst, SkIRect area) {
+        // Baked frames are whole frames in the output format, decompressed straight into the image
+        if (flipbook.complete() && baked_frame >= 0) return flipbook.read(baked_frame, dst);
+        return sk.copy_to(dst, area);
+    });
+    if (uploaded) owner->queue_redraw();
 }
 
 float RiveViewerBase::get_elapsed_time() const {
     return elapsed;
 }
 
+/* Bytes uploaded to this viewer's own textures so far. Atlas pages are shared, so they aren't counted. */
+int64_t RiveViewerBase::get_uploaded_bytes() const {
+    return textures.uploaded_bytes + tiles.uploaded_bytes;
+}
+
 Ref<RiveFile> RiveViewerBase::get_file() const {
+    sync();
     return inst.file;
 }
 
 Ref<RiveArtboard> RiveViewerBase::get_artboard() const {
+    sync();
     return inst.artboard();
 }
 
 Ref<RiveScene> RiveViewerBase::get_scene() const {
+    sync();
     return inst.scene();
 }
 
 Ref<RiveAnimation> RiveViewerBase::get_animation() const {
+    sync();
     return inst.animation();
 }
 
 void RiveViewerBase::go_to_artboard(Ref<RiveArtboard> artboard_value) {
+    sync();
     try {
         if (is_null(artboard_value))
             throw RiveException("Attempted to go to null artboard").from(owner, "go_to_artboard").warning();
@@ -263,6 +796,7 @@ void RiveViewerBase::go_to_artboard(Ref<RiveArtboard> artboard_value) {
 }
 
 void RiveViewerBase::go_to_scene(Ref<RiveScene> scene_value) {
+    sync();
     try {
         if (is_null(scene_value))
             throw RiveException("Attempted to go to null scene").from(owner, "go_to_scene").warning();
@@ -273,6 +807,7 @@ void RiveViewerBase::go_to_scene(Ref<RiveScene> scene_value) {
 }
 
 void RiveViewerBase::go_to_animation(Ref<RiveAnimation> animation_value) {
+    sync();
     try {
         if (is_null(animation_value))
             throw RiveException("Attempted to go to null animation").from(owner, "go_to_animation").warning();
@@ -287,13 +822,13 @@ void RiveViewerBase::go_to_animation(Ref<RiveAnimation> animation_value) {
 }
 
 void RiveViewerBase::press_mouse(Vector2 position) {
-    inst.press_mouse(position);
+    queue_input([this, position]() { inst.press_mouse(position); });
 }
 
 void RiveViewerBase::release_mouse(Vector2 position) {
-    inst.release_mouse(position);
+    queue_input([this, position]() { inst.release_mouse(position); });
 }
 
 void RiveViewerBase::move_mouse(Vector2 position) {
-    inst.move_mouse(position);
+    queue_input([this, position]() { inst.move_mouse(position); });
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define RIVEEXTENSION_VIEWER_BASE_H
 
 // stdlib
+#include <mutex>
 #include <vector>
 
 // godot-cpp
@@ -32,8 +33,16 @@
 
 // extension
 #include "api/rive_file.hpp"
+#include "crowd_registry.hpp"
+#include "flipbook.hpp"
+#include "output_material.hpp"
+#include "render_coordinator.hpp"
+#include "render_worker.hpp"
 #include "rive_instance.hpp"
 #include "skia_instance.hpp"
+#include "texture_atlas.hpp"
+#include "texture_ring.hpp"
+#include "tile_grid.hpp"
 #include "utils/out_redirect.hpp"
 #include "utils/types.hpp"
 #include "viewer_props.hpp"
@@ -51,9 +60,29 @@ class RiveViewerBase {
     RiveInstance inst;
     SkiaInstance sk;
     float elapsed = 0;
+    float pending_delta = 0;
+    float frame_phase = 0;
+    float raster_time = 0;
+    int frames_since_rescale = 0;
+    bool changing = true;
+    bool sleeping = false;
+    bool invalidated = false;
     Dictionary cached_scene_property_values;
-    Ref<Image> image;
-    Ref<ImageTexture> texture;
+    TextureRing textures;
+    AtlasSlot atlas_slot;
+    TileGrid tiles;
+    Flipbook flipbook;
+    float bake_time = 0;
+    float bake_pending = 0;
+    int baked_frame = -1;
+    String crowd_key;
+    bool following = false;
+    SkIRect damage;
+    bool rendered = false;
+    int drawn_flags = OUTPUT_DEFAULT;
+    std::mutex input_mutex;
+    std::vector<Callback<>> queued_inputs;
+    mutable RenderWorker worker;
 
    protected:
     void _on_path_changed(String path);
@@ -64,11 +93,42 @@ class RiveViewerBase {
     void _on_transform_changed();
     void check_scene_property_changed();
     bool advance(float delta);
-    PackedByteArray frame(float delta);
-    PackedByteArray redraw();
+    bool frame(float delta);
+    bool render(float delta, bool visible);
+    bool redraw();
+    bool render_baked(float delta, bool visible);
+    bool wants_bake() const;
+    bool rasterize(const SkIRect &area);
+    bool rasterize_tiles(const SkIRect &area);
+    SkIRect raster_bounds() const;
+    void update_visible_tiles();
+    void present();
+    void upload();
+    bool use_atlas() const;
+    void finish_frame();
+    void update_render_scale();
+    void update_lod();
+    bool wants_antialias() const;
+    void update_antialias();
+    int output_flags() const;
+    void draw_frame(CanvasItem *target, const Rect2 &rect);
+    String get_crowd_key() const;
+    void update_crowd();
+    bool can_lead() const;
+    static void wake_crowd(const String &key);
+    RiveViewerBase *frame_source();
+    const RiveViewerBase *frame_source() const;
+    bool is_modulate_opaque() const;
+    void sleep();
+    void wake();
+    void sync() const;
+    void commit();
+    void queue_input(Callback<> input);
+    void apply_queued_inputs();
 
    public:
     RiveViewerBase(CanvasItem *owner);
+    ~RiveViewerBase();
 
     void on_ready();
     void on_draw();
@@ -84,14 +144,17 @@ class RiveViewerBase {
     /* Setters */
 
     void set_file_path(String value) {
+        sync();
         props.path(value);
     }
 
     void set_fit(int value) {
+        sync();
         props.fit((FIT)value);
     }
 
     void set_alignment(int value) {
+        sync();
         props.alignment((ALIGN)value);
     }
 
@@ -105,9 +168,96 @@ class RiveViewerBase {
 
     void set_paused(bool value) {
         props.paused(value);
+        if (!value) wake();
+        update_crowd();
+    }
+
+    void set_auto_sleep(bool value) {
+        props.auto_sleep(value);
+        if (!value) wake();
+    }
+
+    void set_pixel_format(int value) {
+        sync();
+        props.pixel_format((PIXEL_FORMAT)value);
+    }
+
+    void set_buffer_count(int value) {
+        sync();
+        props.buffer_count(value);
+    }
+
+    void set_threading(int value) {
+        sync();
+        props.threading((THREADING)value);
+    }
+
+    void set_premultiplied_alpha(bool value) {
+        sync();
+        props.premultiplied_alpha(value);
+    }
+
+    void set_atlas(bool value) {
+        sync();
+        props.atlas(value);
+    }
+
+    void set_max_fps(int value) {
+        props.max_fps(value);
+        update_crowd();
+    }
+
+    void set_render_scale(float value) {
+        sync();
+        props.render_scale(value);
+    }
+
+    void set_tiled(bool value) {
+        sync();
+        // Created here on the main thread, rather than by the first tiled frame on a render thread
+        if (value) RiveRenderCoordinator::get_singleton();
+        props.tiled(value);
+    }
+
+    void set_virtual_tiles(bool value) {
+        sync();
+        props.virtual_tiles(value);
+    }
+
+    void set_layer_cache(bool value) {
+        sync();
+        props.layer_cache(value);
+    }
+
+    void set_bake_fps(int value) {
+        sync();
+        props.bake_fps(value);
+        flipbook.clear();
+    }
+
+    void set_share_group(int value) {
+        props.share_group(value);
+        update_crowd();
+    }
+
+    void set_antialiasing(int value) {
+        sync();
+        props.antialiasing((ANTIALIASING)value);
+    }
+
+    void set_auto_lod(bool value) {
+        sync();
+        props.auto_lod(value);
+    }
+
+    void set_frame_budget(float value) {
+        sync();
+        props.frame_budget(value);
+        if (value <= 0) props.auto_scale(1.0);
     }
 
     void set_size(Vector2 value) {
+        sync();
         props.size(value.x, value.y);
     }
 
@@ -137,6 +287,70 @@ class RiveViewerBase {
         return props.paused();
     }
 
+    bool get_auto_sleep() const {
+        return props.auto_sleep();
+    }
+
+    int get_pixel_format() const {
+        return props.pixel_format();
+    }
+
+    int get_buffer_count() const {
+        return props.buffer_count();
+    }
+
+    int get_threading() const {
+        return props.threading();
+    }
+
+    bool get_premultiplied_alpha() const {
+        return props.premultiplied_alpha();
+    }
+
+    bool get_atlas() const {
+        return props.atlas();
+    }
+
+    int get_max_fps() const {
+        return props.max_fps();
+    }
+
+    float get_render_scale() const {
+        return props.render_scale();
+    }
+
+    float get_frame_budget() const {
+        return props.frame_budget();
+    }
+
+    bool get_auto_lod() const {
+        return props.auto_lod();
+    }
+
+    int get_antialiasing() const {
+        return props.antialiasing();
+    }
+
+    bool get_tiled() const {
+        return props.tiled();
+    }
+
+    bool get_virtual_tiles() const {
+        return props.virtual_tiles();
+    }
+
+    bool get_layer_cache() const {
+        return props.layer_cache();
+    }
+
+    int get_bake_fps() const {
+        return props.bake_fps();
+    }
+
+    int get_share_group() const {
+        return props.share_group();
+    }
+
     Vector2 get_size() const {
         return props.size();
     }
@@ -147,11 +361,14 @@ class RiveViewerBase {
 
     void released(Vector2 position) const {}
 
+    void settled() const {}
+
     void scene_property_changed(Ref<RiveScene> scene, String property, Variant new_value, Variant old_value) const {}
 
     /* API */
 
     float get_elapsed_time() const;
+    int64_t get_uploaded_bytes() const;
     Ref<RiveFile> get_file() const;
     Ref<RiveArtboard> get_artboard() const;
     Ref<RiveScene> get_scene() const;
@@ -187,8 +404,33 @@ class RiveViewerBase {
     ADD_PROP(cls, Variant::BOOL, disable_press);                                                 \
     ADD_PROP(cls, Variant::BOOL, disable_hover);                                                 \
     ADD_PROP(cls, Variant::BOOL, paused);                                                        \
+    ADD_PROP(cls, Variant::BOOL, auto_sleep);                                                    \
+    ADD_PROP(cls, Variant::BOOL, premultiplied_alpha);                                           \
+    ADD_PROP(cls, Variant::BOOL, atlas);                                                         \
+    ADD_PROP_WITH_HINT(cls, Variant::INT, max_fps, PROPERTY_HINT_RANGE, "0,240,1,or_greater");   \
+    ADD_PROP_WITH_HINT(cls, Variant::FLOAT, render_scale, PROPERTY_HINT_RANGE, "0.25,1,0.05");   \
+    ADD_PROP_WITH_HINT(cls, Variant::FLOAT, frame_budget, PROPERTY_HINT_RANGE, "0,33,0.1");      \
+    ADD_PROP(cls, Variant::BOOL, auto_lod);                                                      \
+    ADD_PROP(cls, Variant::BOOL, tiled);                                                         \
+    ADD_PROP(cls, Variant::BOOL, virtual_tiles);                                                 \
+    ADD_PROP(cls, Variant::BOOL, layer_cache);                                                   \
+    ADD_PROP_WITH_HINT(cls, Variant::INT, bake_fps, PROPERTY_HINT_RANGE, "0,60,1,or_greater");   \
+    ADD_PROP_WITH_HINT(                                                                          \
+        cls, Variant::INT, share_group, PROPERTY_HINT_RANGE, "-1,64,1,or_greater"                \
+    );                                                                                           \
+    ADD_PROP_WITH_HINT(                                                                          \
+        cls, Variant::INT, antialiasing, PROPERTY_HINT_ENUM, AntialiasingEnumPropertyHint        \
+    );                                                                                           \
+    ADD_PROP_WITH_HINT(cls, Variant::INT, buffer_count, PROPERTY_HINT_RANGE, "1,3");             \
+    ADD_PROP_WITH_HINT(                                                                          \
+        cls, Variant::INT, threading, PROPERTY_HINT_ENUM, ThreadingEnumPropertyHint              \
+    );                                                                                           \
+    ADD_PROP_WITH_HINT(                                                                          \
+        cls, Variant::INT, pixel_format, PROPERTY_HINT_ENUM, PixelFormatEnumPropertyHint         \
+    );                                                                                           \
     ADD_SIGNAL(MethodInfo("pressed", PropertyInfo(Variant::VECTOR2, "position")));               \
     ADD_SIGNAL(MethodInfo("released", PropertyInfo(Variant::VECTOR2, "position")));              \
+    ADD_SIGNAL(MethodInfo("settled"));                                                           \
     ADD_SIGNAL(MethodInfo(                                                                       \
         "scene_property_changed",                                                                \
         PropertyInfo(Variant::OBJECT, "scene"),                                                  \
@@ -197,6 +439,7 @@ class RiveViewerBase {
         PropertyInfo(Variant::VARIANT_MAX, "old_value")                                          \
     ));                                                                                          \
     BIND_GET(cls, elapsed_time);                                                                 \
+    BIND_GET(cls, uploaded_bytes);                                                               \
     BIND_GET(cls, file);                                                                         \
     BIND_GET(cls, artboard);                                                                     \
     BIND_GET(cls, scene);                                                                        \
@@ -235,7 +478,24 @@ class RiveViewerBase {
     RIVE_VIEWER_SETGET(bool, disable_press)                                  \
     RIVE_VIEWER_SETGET(bool, disable_hover)                                  \
     RIVE_VIEWER_SETGET(bool, paused)                                         \
+    RIVE_VIEWER_SETGET(bool, auto_sleep)                                     \
+    RIVE_VIEWER_SETGET(bool, premultiplied_alpha)                            \
+    RIVE_VIEWER_SETGET(int, pixel_format)                                    \
+    RIVE_VIEWER_SETGET(int, buffer_count)                                    \
+    RIVE_VIEWER_SETGET(int, threading)                                       \
+    RIVE_VIEWER_SETGET(bool, atlas)                                          \
+    RIVE_VIEWER_SETGET(int, max_fps)                                         \
+    RIVE_VIEWER_SETGET(float, render_scale)                                  \
+    RIVE_VIEWER_SETGET(float, frame_budget)                                  \
+    RIVE_VIEWER_SETGET(bool, auto_lod)                                       \
+    RIVE_VIEWER_SETGET(int, antialiasing)                                    \
+    RIVE_VIEWER_SETGET(bool, tiled)                                          \
+    RIVE_VIEWER_SETGET(bool, virtual_tiles)                                  \
+    RIVE_VIEWER_SETGET(bool, layer_cache)                                    \
+    RIVE_VIEWER_SETGET(int, bake_fps)                                        \
+    RIVE_VIEWER_SETGET(int, share_group)                                     \
     RIVE_VIEWER_GET(float, elapsed_time)                                     \
+    RIVE_VIEWER_GET(int64_t, uploaded_bytes)                                 \
     RIVE_VIEWER_GET(Ref<RiveFile>, file)                                     \
     RIVE_VIEWER_GET(Ref<RiveArtboard>, artboard)                             \
     RIVE_VIEWER_GET(Ref<RiveScene>, scene)                                   \
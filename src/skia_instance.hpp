@@ -1,30 +1,69 @@
 #ifndef _RIVEEXTENSION_SKIA_INSTANCE_HPP_
 #define _RIVEEXTENSION_SKIA_INSTANCE_HPP_
 
+// stdlib
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
 // godot-cpp
+#include <godot_cpp/classes/image.hpp>
 #include <godot_cpp/variant/builtin_types.hpp>
 
 // skia
 #include <skia/dependencies/skia/include/core/SkBitmap.h>
+#include <skia/dependencies/skia/include/core/SkBBHFactory.h>
 #include <skia/dependencies/skia/include/core/SkCanvas.h>
+#include <skia/dependencies/skia/include/core/SkImage.h>
+#include <skia/dependencies/skia/include/core/SkPaint.h>
+#include <skia/dependencies/skia/include/core/SkPicture.h>
+#include <skia/dependencies/skia/include/core/SkPictureRecorder.h>
 #include <skia/dependencies/skia/include/core/SkSurface.h>
 
 #include <skia/renderer/include/skia_factory.hpp>
 #include <skia/renderer/include/skia_renderer.hpp>
 
 // extension
+#include "antialias_canvas.hpp"
+#include "layer_renderer.hpp"
+#include "surface_pool.hpp"
 #include "utils/types.hpp"
 #include "viewer_props.hpp"
 
 using namespace godot;
 using namespace rive;
 
+/* Bands thinner than this aren't worth a thread of their own. */
+static const int MIN_BAND_HEIGHT = 64;
+
 struct SkiaInstance {
     ViewerProps *props;
+    Ptr<SurfaceBuffer> buffer;
+    uint8_t *external_pixels = nullptr;
+    size_t external_row_bytes = 0;
+    uint8_t *surface_pixels = nullptr;
     sk_sp<SkSurface> surface;
     Ptr<SkiaRenderer> renderer;
+    Ptr<AliasedCanvas> aliased_canvas;
+    sk_sp<SkPicture> picture;
+    // The static draw calls under `picture`, and the layer they were last rasterized into
+    sk_sp<SkPicture> base_picture;
+    uint64_t base_key = 0;
+    Ptr<SurfaceBuffer> layer;
+    sk_sp<SkImage> layer_image;
+    uint64_t layer_key = 0;
+    bool antialias = true;
     Ptr<SkiaFactory> factory = rivestd::make_unique<SkiaFactory>();
 
+    ~SkiaInstance() {
+        renderer = nullptr;
+        aliased_canvas = nullptr;
+        surface = nullptr;
+        layer_image = nullptr;
+        SurfacePool::get().release(std::move(buffer));
+        SurfacePool::get().release(std::move(layer));
+    }
+
     void set_props(ViewerProps *props_value) {
         props = props_value;
         if (props) {
@@ -32,41 +71,314 @@ struct SkiaInstance {
         }
     }
 
+    /**
+     * Skia always rasterizes premultiplied, so the surface stays premultiplied regardless of the output mode.
+     * The native format is Skia's fastest raster format (BGRA on most desktops), uploaded without reordering.
+     * Opaque scenes get an opaque surface, which Skia fills without blending and which never needs a clear.
+     */
     SkImageInfo image_info() const {
+        // The low bandwidth formats are rasterized at full precision and only reduced when copied out
+        bool native = props && props->pixel_format() == PIXEL_FORMAT::NATIVE;
+        // A virtualized viewer only needs a surface the size of one tile, which it rasterizes every tile through
+        bool virtual_tiles = props && props->virtual_tiles();
         return SkImageInfo::Make(
-            props ? props->width() : 1,
-            props ? props->height() : 1,
-            SkColorType::kRGBA_8888_SkColorType,
-            SkAlphaType::kUnpremul_SkAlphaType
+            props ? (virtual_tiles ? VIRTUAL_TILE_SIZE : props->raster_width()) : 1,
+            props ? (virtual_tiles ? VIRTUAL_TILE_SIZE : props->raster_height()) : 1,
+            native ? SkColorType::kN32_SkColorType : SkColorType::kRGBA_8888_SkColorType,
+            props && props->opaque() ? SkAlphaType::kOpaque_SkAlphaType : SkAlphaType::kPremul_SkAlphaType
         );
     }
 
-    PackedByteArray bytes() const {
+    /**
+     * The layout of the pixels handed to Godot. The 16 and 8 bit formats are converted from the 32 bit surface
+     * while copying. RGB565 and L8 have no alpha, so they're meant for opaque scenes.
+     */
+    SkImageInfo output_info() const {
+        bool premultiplied = props && props->premultiplied_alpha();
+        SkImageInfo info = surface ? surface->imageInfo() : image_info();
+        switch (props && !external_pixels ? props->pixel_format() : PIXEL_FORMAT::RGBA8) {
+            case PIXEL_FORMAT::RGBA4444:
+                info = info.makeColorType(kARGB_4444_SkColorType);
+                break;
+            case PIXEL_FORMAT::RGB565:
+                return info.makeColorType(kRGB_565_SkColorType).makeAlphaType(kOpaque_SkAlphaType);
+            case PIXEL_FORMAT::L8:
+                return info.makeColorType(kGray_8_SkColorType).makeAlphaType(kOpaque_SkAlphaType);
+            default:
+                break;
+        }
+        if (info.isOpaque()) return info;
+        return info.makeAlphaType(premultiplied ? kPremul_SkAlphaType : kUnpremul_SkAlphaType);
+    }
+
+    int width() const {
+        return surface ? surface->width() : 0;
+    }
+
+    int height() const {
+        return surface ? surface->height() : 0;
+    }
+
+    bool opaque() const {
+        return surface && surface->imageInfo().isOpaque();
+    }
+
+    /* Whether the uploaded red and blue channels are swapped and need to be swapped back when drawn, as with BGRA. */
+    bool swizzled() const {
+        return surface && output_info().colorType() == kBGRA_8888_SkColorType;
+    }
+
+    /* The Godot image format matching `output_info()`. */
+    Image::Format image_format() const {
+        switch (output_info().colorType()) {
+            case kARGB_4444_SkColorType:
+                return Image::FORMAT_RGBA4444;
+            case kRGB_565_SkColorType:
+                return Image::FORMAT_RGB565;
+            case kGray_8_SkColorType:
+                return Image::FORMAT_L8;
+            default:
+                return Image::FORMAT_RGBA8;
+        }
+    }
+
+    size_t byte_size() const {
+        return surface ? surface->imageInfo().computeMinByteSize() : 0;
+    }
+
+    /**
+     * Rasterizes into memory owned by someone else (an atlas page) instead of a pooled surface, from the next
+     * surface rebuild on. External memory is always RGBA8. Pass nullptr to go back to a pooled surface.
+     */
+    void use_pixels(uint8_t *memory, size_t row_bytes) {
+        external_pixels = memory;
+        external_row_bytes = row_bytes;
+    }
+
+    /**
+     * Copies the `area` of the rasterized frame into `dst`, an image of the same size as the surface. Skia renders
+     * straight into the surface's memory, so this single bulk copy is the only work between rasterization and
+     * upload. When the output is unpremultiplied, the conversion happens during the same pass using Skia's SIMD
+     * pixel conversion.
+     */
+    bool copy_to(uint8_t *dst, SkIRect area) const {
         SkPixmap pixmap;
-        PackedByteArray bytes;
-        if (!surface) return bytes;
-        if (!surface->peekPixels(&pixmap)) return bytes;
-        SkImageInfo info = surface->imageInfo();
-        size_t bytes_per_pixel = info.bytesPerPixel(), row_bytes = pixmap.rowBytes();
-        bytes.resize(row_bytes * info.height());
-        for (int y = 0; y < info.height(); y++) {
-            for (int x = 0; x < info.width(); x++) {
-                int offset = y * row_bytes + x * bytes_per_pixel;
-                auto addr = pixmap.addr32(x, y);
-                bytes.encode_u32(offset, *addr);
-            }
+        if (!surface || !dst || !surface->peekPixels(&pixmap)) return false;
+        SkImageInfo info = pixmap.info();
+        SkImageInfo out = output_info();
+        if (!area.intersect(info.bounds())) return false;
+        if (out == info && area == info.bounds() && pixmap.rowBytes() == out.minRowBytes()) {
+            memcpy(dst, pixmap.addr(), pixmap.computeByteSize());
+            return true;
         }
-        return bytes;
+        size_t row_bytes = out.minRowBytes();
+        return pixmap.readPixels(
+            out.makeWH(area.width(), area.height()),
+            dst + area.top() * row_bytes + area.left() * out.bytesPerPixel(),
+            row_bytes,
+            area.left(),
+            area.top()
+        );
+    }
+
+    bool copy_to(uint8_t *dst) const {
+        return copy_to(dst, bounds());
+    }
+
+    SkIRect bounds() const {
+        return SkIRect::MakeWH(width(), height());
+    }
+
+    /**
+     * Starts drawing a frame that only touches `area`: everything outside it keeps the previous frame's pixels.
+     * Must be balanced by `end_frame()`.
+     */
+    void begin_frame(const SkIRect &area) {
+        if (!surface || !renderer) return;
+        SkCanvas *canvas = draw_canvas();
+        canvas->save();
+        canvas->clipIRect(area);
+        // The artboard's background repaints every pixel of an opaque surface
+        if (!surface->imageInfo().isOpaque()) canvas->clear(SkColors::kTransparent);
+    }
+
+    void end_frame() {
+        if (surface && renderer) draw_canvas()->restore();
+    }
+
+    /**
+     * Records the draw calls of one frame, in artboard space, so the frame can be rasterized again without walking
+     * the artboard. The recording keeps a bounding box hierarchy, so replaying into a small area skips every draw
+     * call outside of it.
+     */
+    void record(const SkRect &bounds, Callback<rive::Renderer *> draw) {
+        SkPictureRecorder recorder;
+        SkRTreeFactory rtree;
+        SkiaRenderer recording_renderer(recorder.beginRecording(bounds, &rtree));
+        draw(&recording_renderer);
+        picture = recorder.finishRecordingAsPicture();
+        base_picture = nullptr;
+        base_key = 0;
+    }
+
+    /**
+     * Like `record`, but records the static draw calls at the bottom of the frame separately, into `base_picture`.
+     * Replaying rasterizes them into a layer once and blits that layer until they change, so only the draw calls
+     * above it are rasterized every frame.
+     */
+    void record(
+        const SkRect &bounds, Callback<rive::Renderer *> draw, Fn<uint64_t, const rive::RenderPaint *> static_signature
+    ) {
+        SkPictureRecorder base_recorder, top_recorder;
+        SkRTreeFactory rtree;
+        SkiaRenderer base_renderer(base_recorder.beginRecording(bounds, &rtree));
+        SkiaRenderer top_renderer(top_recorder.beginRecording(bounds, &rtree));
+        LayerRenderer splitter(&base_renderer, &top_renderer, static_signature);
+        draw(&splitter);
+        picture = top_recorder.finishRecordingAsPicture();
+        base_picture = base_recorder.finishRecordingAsPicture();
+        base_key = splitter.base_draws > 0 ? splitter.key : 0;
+    }
+
+    /* Rasterizes the last recorded frame into `area` of the surface, with `transform` from artboard space. */
+    bool replay(const SkIRect &area, const rive::Mat2D &transform) {
+        if (!picture || !surface || !renderer) return false;
+        update_layer(transform);
+        begin_frame(area);
+        draw_frame(draw_canvas(), renderer.get(), transform);
+        end_frame();
+        return true;
+    }
+
+    /**
+     * Like `replay`, but splits `area` into horizontal bands that `parallel_for` rasterizes at the same time. Every
+     * band draws into its own rows of the surface's memory, through a surface of its own, so no two threads ever
+     * share a canvas or a pixel.
+     */
+    bool replay_tiled(const SkIRect &area, const rive::Mat2D &transform, Fn<void, int, Fn<void, int>> parallel_for) {
+        SkPixmap pixmap;
+        if (!picture || !surface || !renderer || !surface->peekPixels(&pixmap)) return false;
+        int threads = std::max((int)std::thread::hardware_concurrency(), 1);
+        int count = std::clamp(area.height() / MIN_BAND_HEIGHT, 1, threads);
+        if (count == 1) return replay(area, transform);
+        int band_height = (area.height() + count - 1) / count;
+        update_layer(transform);
+        parallel_for(count, [&](int i) {
+            SkIRect band = SkIRect::MakeLTRB(
+                area.left(), area.top() + i * band_height, area.right(), area.top() + (i + 1) * band_height
+            );
+            if (!band.intersect(area)) return;
+            SkImageInfo band_info = pixmap.info().makeWH(pixmap.width(), band.height());
+            void *rows = pixmap.writable_addr(0, band.top());
+            auto band_surface = SkSurface::MakeRasterDirect(band_info, rows, pixmap.rowBytes());
+            if (!band_surface) return;
+            SkCanvas *canvas = band_surface->getCanvas();
+            Ptr<AliasedCanvas> aliased = antialias ? nullptr : std::make_unique<AliasedCanvas>(canvas);
+            if (aliased) canvas = aliased.get();
+            canvas->translate(0, -band.top());
+            canvas->clipIRect(band);
+            if (!pixmap.info().isOpaque()) canvas->clear(SkColors::kTransparent);
+            SkiaRenderer band_renderer(canvas);
+            draw_frame(canvas, &band_renderer, transform);
+        });
+        return true;
     }
 
-    void clear() {
-        if (surface && renderer) surface->getCanvas()->clear(SkColors::kTransparent);
+    /* Turns anti-aliasing on or off for everything the renderer draws from now on. Returns whether it changed. */
+    bool set_antialias(bool value) {
+        if (antialias == value) return false;
+        antialias = value;
+        layer_key = 0;
+        rebuild_renderer();
+        return true;
+    }
+
+    /* The canvas the renderer draws into. Frames must be started and ended on the same one. */
+    SkCanvas *draw_canvas() const {
+        if (aliased_canvas) return aliased_canvas.get();
+        return surface ? surface->getCanvas() : nullptr;
     }
 
    private:
+    /**
+     * Draws the recorded frame into a canvas already clipped to the area being rasterized: the cached layer if
+     * there is one, otherwise the static draw calls, and then everything above them.
+     */
+    void draw_frame(SkCanvas *canvas, rive::Renderer *frame_renderer, const rive::Mat2D &transform) const {
+        if (layer_image) {
+            // Replaces whatever was there, so opaque surfaces that skip the clear come out right too
+            SkPaint paint;
+            paint.setBlendMode(SkBlendMode::kSrc);
+            canvas->drawImage(layer_image, 0, 0, SkSamplingOptions(), &paint);
+        }
+        // Played back op by op, so the draw canvas can still override paints
+        frame_renderer->transform(transform);
+        if (!layer_image && base_picture) base_picture->playback(canvas);
+        picture->playback(canvas);
+    }
+
+    /**
+     * Rasterizes the static draw calls into the layer when they changed since the layer was last rasterized. The
+     * layer matches the surface pixel for pixel, and is rasterized in full, so any area can be composited from it.
+     */
+    void update_layer(const rive::Mat2D &transform) {
+        if (!base_key) {
+            layer_image = nullptr;
+            layer_key = 0;
+            return;
+        }
+        if (layer_image && layer_key == base_key) return;
+        // Dropping the snapshot first lets the layer be drawn into without a copy on write
+        layer_image = nullptr;
+        layer_key = 0;
+        SkImageInfo info = surface->imageInfo();
+        if (!layer || layer->info() != info) {
+            SurfacePool::get().release(std::move(layer));
+            layer = SurfacePool::get().acquire(info);
+            if (!layer) return;
+        }
+        SkCanvas *canvas = layer->surface->getCanvas();
+        Ptr<AliasedCanvas> aliased = antialias ? nullptr : std::make_unique<AliasedCanvas>(canvas);
+        if (aliased) canvas = aliased.get();
+        canvas->save();
+        canvas->clear(SkColors::kTransparent);
+        SkiaRenderer layer_renderer(canvas);
+        layer_renderer.transform(transform);
+        base_picture->playback(canvas);
+        canvas->restore();
+        layer_image = layer->surface->makeImageSnapshot();
+        layer_key = base_key;
+    }
+
+    /**
+     * The layout transform is applied to the canvas every frame, so fit, alignment and artboard changes keep the
+     * current surface and renderer. Only a new size, format or memory source rebuilds them.
+     */
     void on_transform_changed() {
-        surface = SkSurface::MakeRaster(image_info());
-        renderer = rivestd::make_unique<SkiaRenderer>(surface->getCanvas());
+        // The layer was rasterized with the previous layout
+        layer_image = nullptr;
+        layer_key = 0;
+        SkImageInfo info = image_info();
+        if (external_pixels) info = info.makeColorType(kRGBA_8888_SkColorType);
+        if (surface && surface->imageInfo() == info && surface_pixels == external_pixels) return;
+        renderer = nullptr;
+        aliased_canvas = nullptr;
+        surface = nullptr;
+        SurfacePool::get().release(std::move(buffer));
+        if (external_pixels) {
+            surface = SkSurface::MakeRasterDirect(info, external_pixels, external_row_bytes);
+        } else {
+            buffer = SurfacePool::get().acquire(info);
+            if (buffer) surface = buffer->surface;
+        }
+        surface_pixels = external_pixels;
+        rebuild_renderer();
+    }
+
+    void rebuild_renderer() {
+        renderer = nullptr;
+        aliased_canvas = surface && !antialias ? std::make_unique<AliasedCanvas>(surface->getCanvas()) : nullptr;
+        renderer = surface ? rivestd::make_unique<SkiaRenderer>(draw_canvas()) : nullptr;
     }
 };
 
@@ -0,0 +1,90 @@
+#ifndef _RIVEEXTENSION_SURFACE_POOL_HPP_
+#define _RIVEEXTENSION_SURFACE_POOL_HPP_
+
+// stdlib
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+// skia
+#include <skia/dependencies/skia/include/core/SkImageInfo.h>
+#include <skia/dependencies/skia/include/core/SkSurface.h>
+
+// extension
+#include "utils/types.hpp"
+
+/* Surfaces kept per size and format, and in total, once no viewer is using them. */
+static const int MAX_POOLED_SURFACES = 4;
+static const size_t MAX_POOLED_BYTES = 64 * 1024 * 1024;
+
+/* Raster memory together with the surface that draws into it. */
+struct SurfaceBuffer {
+    std::vector<uint8_t> pixels;
+    sk_sp<SkSurface> surface;
+
+    SkImageInfo info() const {
+        return surface ? surface->imageInfo() : SkImageInfo::MakeUnknown();
+    }
+};
+
+/**
+ * Shared raster surfaces, keyed by size and format. Viewers return their surface when they're resized or freed, so
+ * the next viewer of that size reuses it instead of allocating and zero-filling a new one. Pooled pixels are stale,
+ * which is fine: a new surface always gets a full redraw.
+ */
+struct SurfacePool {
+   private:
+    using Key = std::tuple<int, int, int>;
+
+    std::mutex mutex;
+    std::map<Key, std::vector<Ptr<SurfaceBuffer>>> buffers;
+    size_t pooled_bytes = 0;
+
+    static Key key(const SkImageInfo &info) {
+        return { info.width(), info.height(), info.colorType() };
+    }
+
+   public:
+    static SurfacePool &get() {
+        static SurfacePool pool;
+        return pool;
+    }
+
+    Ptr<SurfaceBuffer> acquire(const SkImageInfo &info) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto &pooled = buffers[key(info)];
+            for (auto it = pooled.begin(); it != pooled.end(); it++) {
+                if ((*it)->info().alphaType() != info.alphaType()) continue;
+                Ptr<SurfaceBuffer> buffer = std::move(*it);
+                pooled.erase(it);
+                pooled_bytes -= buffer->pixels.size();
+                return buffer;
+            }
+        }
+        auto buffer = std::make_unique<SurfaceBuffer>();
+        buffer->pixels.resize(info.computeMinByteSize());
+        buffer->surface = SkSurface::MakeRasterDirect(info, buffer->pixels.data(), info.minRowBytes());
+        if (!buffer->surface) return nullptr;
+        return buffer;
+    }
+
+    void release(Ptr<SurfaceBuffer> buffer) {
+        if (!buffer || !buffer->surface) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto &pooled = buffers[key(buffer->info())];
+        size_t size = buffer->pixels.size();
+        if (pooled.size() >= MAX_POOLED_SURFACES || pooled_bytes + size > MAX_POOLED_BYTES) return;
+        pooled_bytes += size;
+        pooled.push_back(std::move(buffer));
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        buffers.clear();
+        pooled_bytes = 0;
+    }
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,195 @@
+#ifndef _RIVEEXTENSION_TEXTURE_ATLAS_HPP_
+#define _RIVEEXTENSION_TEXTURE_ATLAS_HPP_
+
+// stdlib
+#include <vector>
+
+// godot-cpp
+#include <godot_cpp/classes/image.hpp>
+#include <godot_cpp/classes/image_texture.hpp>
+#include <godot_cpp/classes/ref.hpp>
+
+// skia
+#include <skia/dependencies/skia/include/core/SkImageInfo.h>
+#include <skia/dependencies/skia/include/core/SkPixmap.h>
+#include <skia/dependencies/skia/include/core/SkRect.h>
+
+// extension
+#include "render_coordinator.hpp"
+#include "utils/types.hpp"
+
+using namespace godot;
+
+static const int ATLAS_PAGE_SIZE = 1024;
+static const int ATLAS_MAX_SLOT_SIZE = 256;
+static const int ATLAS_PADDING = 1;
+
+struct AtlasSlot {
+    int page = -1;
+    SkIRect rect = SkIRect::MakeEmpty();
+    bool premultiplied = false;
+
+    bool valid() const {
+        return page >= 0;
+    }
+
+    bool matches(int width, int height, bool premultiplied_value) const {
+        return valid() && rect.width() == width && rect.height() == height && premultiplied == premultiplied_value;
+    }
+};
+
+/**
+ * Shared pages that small viewers rasterize into directly. Each page is one pixel buffer, image and texture, so
+ * every changed viewer on a page is covered by a single upload per frame, and viewers drawing from the same page
+ * don't break canvas batches.
+ *
+ * Slots are packed onto shelves, with a pixel of padding between them so filtering never samples a neighbour.
+ */
+struct TextureAtlas {
+   private:
+    struct Shelf {
+        int y;
+        int height;
+        int cursor;
+    };
+
+    struct Page {
+        bool premultiplied;
+        std::vector<uint8_t> pixels;
+        Ref<Image> image;
+        Ref<ImageTexture> texture;
+        std::vector<Shelf> shelves;
+        std::vector<SkIRect> free_rects;
+        SkIRect dirty = SkIRect::MakeEmpty();
+        int users = 0;
+    };
+
+    std::vector<Ptr<Page>> pages;
+    bool flush_queued = false;
+
+   public:
+    static TextureAtlas &get() {
+        static TextureAtlas atlas;
+        return atlas;
+    }
+
+    static bool fits(int width, int height) {
+        return width <= ATLAS_MAX_SLOT_SIZE && height <= ATLAS_MAX_SLOT_SIZE;
+    }
+
+    static SkImageInfo page_info() {
+        return SkImageInfo::Make(ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, kRGBA_8888_SkColorType, kPremul_SkAlphaType);
+    }
+
+    AtlasSlot allocate(int width, int height, bool premultiplied) {
+        AtlasSlot slot;
+        slot.premultiplied = premultiplied;
+        if (!fits(width, height)) return slot;
+        for (int i = 0; i < pages.size() && !slot.valid(); i++)
+            if (pages[i] && pages[i]->premultiplied == premultiplied && place(*pages[i], width, height, slot.rect))
+                slot.page = i;
+        if (!slot.valid()) {
+            slot.page = add_page(premultiplied);
+            place(*pages[slot.page], width, height, slot.rect);
+        }
+        pages[slot.page]->users++;
+        return slot;
+    }
+
+    void release(AtlasSlot &slot) {
+        if (!slot.valid() || slot.page >= pages.size() || !pages[slot.page]) return;
+        auto &page = *pages[slot.page];
+        const SkIRect &rect = slot.rect;
+        int width = rect.width() + ATLAS_PADDING, height = rect.height() + ATLAS_PADDING;
+        page.free_rects.push_back(SkIRect::MakeXYWH(rect.left(), rect.top(), width, height));
+        if (--page.users == 0) pages[slot.page] = nullptr;
+        slot = AtlasSlot();
+    }
+
+    /* The slot's top-left pixel in the page buffer. Rows are `row_bytes()` apart. */
+    uint8_t *pixels(const AtlasSlot &slot) {
+        if (!slot.valid()) return nullptr;
+        auto &page = *pages[slot.page];
+        return page.pixels.data() + slot.rect.top() * row_bytes() + slot.rect.left() * page_info().bytesPerPixel();
+    }
+
+    static size_t row_bytes() {
+        return page_info().minRowBytes();
+    }
+
+    Ref<ImageTexture> get_texture(const AtlasSlot &slot) const {
+        if (!slot.valid() || slot.page >= pages.size() || !pages[slot.page]) return nullptr;
+        return pages[slot.page]->texture;
+    }
+
+    /* Marks `area` (in slot space) as changed. Pages are uploaded once, after every viewer has rendered. */
+    void mark_dirty(const AtlasSlot &slot, const SkIRect &area) {
+        if (!slot.valid()) return;
+        SkIRect changed = area.makeOffset(slot.rect.left(), slot.rect.top());
+        if (!changed.intersect(slot.rect)) return;
+        pages[slot.page]->dirty.join(changed);
+        if (!flush_queued) {
+            flush_queued = true;
+            RiveRenderCoordinator::get_singleton()->enqueue(this, nullptr, [this]() { flush(); });
+        }
+    }
+
+    /* Must be called before the extension is unloaded, while the rendering server still exists. */
+    void cleanup() {
+        pages.clear();
+    }
+
+   private:
+    int add_page(bool premultiplied) {
+        auto page = std::make_unique<Page>();
+        page->premultiplied = premultiplied;
+        page->pixels.resize(page_info().computeMinByteSize());
+        page->image = Image::create(ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, false, Image::FORMAT_RGBA8);
+        page->texture = ImageTexture::create_from_image(page->image);
+        for (int i = 0; i < pages.size(); i++)
+            if (!pages[i]) {
+                pages[i] = std::move(page);
+                return i;
+            }
+        pages.push_back(std::move(page));
+        return pages.size() - 1;
+    }
+
+    static bool place(Page &page, int width, int height, SkIRect &rect) {
+        int padded_width = width + ATLAS_PADDING, padded_height = height + ATLAS_PADDING;
+        for (auto it = page.free_rects.begin(); it != page.free_rects.end(); it++)
+            if (it->width() >= padded_width && it->height() >= padded_height) {
+                rect = SkIRect::MakeXYWH(it->left(), it->top(), width, height);
+                page.free_rects.erase(it);
+                return true;
+            }
+        for (auto &shelf : page.shelves)
+            if (padded_height <= shelf.height && shelf.cursor + padded_width <= ATLAS_PAGE_SIZE) {
+                rect = SkIRect::MakeXYWH(shelf.cursor, shelf.y, width, height);
+                shelf.cursor += padded_width;
+                return true;
+            }
+        int y = page.shelves.empty() ? 0 : page.shelves.back().y + page.shelves.back().height;
+        if (y + padded_height > ATLAS_PAGE_SIZE) return false;
+        page.shelves.push_back({ y, padded_height, padded_width });
+        rect = SkIRect::MakeXYWH(0, y, width, height);
+        return true;
+    }
+
+    void flush() {
+        flush_queued = false;
+        SkImageInfo info = page_info();
+        for (auto &page : pages) {
+            if (!page || page->dirty.isEmpty()) continue;
+            SkImageInfo out = info.makeAlphaType(page->premultiplied ? kPremul_SkAlphaType : kUnpremul_SkAlphaType);
+            SkIRect &area = page->dirty;
+            uint8_t *dst = page->image->ptrw() + area.top() * row_bytes() + area.left() * info.bytesPerPixel();
+            SkPixmap pixmap(info, page->pixels.data(), row_bytes());
+            pixmap.readPixels(out.makeWH(area.width(), area.height()), dst, row_bytes(), area.left(), area.top());
+            page->texture->update(page->image);
+            page->dirty.setEmpty();
+        }
+    }
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,96 @@
+#ifndef _RIVEEXTENSION_TEXTURE_RING_HPP_
+#define _RIVEEXTENSION_TEXTURE_RING_HPP_
+
+// stdlib
+#include <algorithm>
+#include <vector>
+
+// godot-cpp
+#include <godot_cpp/classes/image.hpp>
+#include <godot_cpp/classes/image_texture.hpp>
+#include <godot_cpp/classes/ref.hpp>
+
+// skia
+#include <skia/dependencies/skia/include/core/SkRect.h>
+
+// extension
+#include "utils/types.hpp"
+
+using namespace godot;
+
+static const int MAX_BUFFER_COUNT = 3;
+
+/**
+ * A ring of textures that frames are written into in turn. While frame N is still being drawn from one texture,
+ * frame N+1 is uploaded to the next one, so an upload never has to wait on a texture that's in use.
+ *
+ * Every slot remembers the area that changed since it was last written, so partial frames stay correct even though
+ * each slot is a few frames behind.
+ */
+struct TextureRing {
+   private:
+    struct Slot {
+        Ref<Image> image;
+        Ref<ImageTexture> texture;
+        SkIRect pending;
+    };
+
+    std::vector<Slot> slots;
+    int front = -1;
+
+   public:
+    /* Bytes pushed to the textures so far. */
+    uint64_t uploaded_bytes = 0;
+
+    void clear() {
+        slots.clear();
+        front = -1;
+    }
+
+    /* Makes sure the ring has `count` slots of the given size and format, recreating them if needed. */
+    void resize(int count, int width, int height, Image::Format format) {
+        count = std::clamp(count, 1, MAX_BUFFER_COUNT);
+        if (slots.size() == (size_t)count) {
+            auto image = slots[0].image;
+            if (image->get_width() == width && image->get_height() == height && image->get_format() == format) return;
+        }
+        clear();
+        for (int i = 0; i < count; i++) {
+            Slot slot;
+            slot.image = Image::create(width, height, false, format);
+            slot.texture = ImageTexture::create_from_image(slot.image);
+            slot.pending = SkIRect::MakeWH(width, height);
+            slots.push_back(slot);
+        }
+    }
+
+    /* Marks `area` as changed in every slot. */
+    void damage(const SkIRect &area) {
+        for (auto &slot : slots) slot.pending.join(area);
+    }
+
+    /**
+     * Writes the next slot and makes it the front. `write` receives the image's storage and the area that changed
+     * since the slot was last written.
+     */
+    bool present(Fn<bool, uint8_t *, SkIRect> write) {
+        if (slots.empty()) return false;
+        int back = (front + 1) % slots.size();
+        Slot &slot = slots[back];
+        if (!slot.pending.isEmpty()) {
+            if (!write(slot.image->ptrw(), slot.pending)) return false;
+            slot.texture->update(slot.image);
+            uploaded_bytes += slot.image->get_data().size();
+            slot.pending.setEmpty();
+        }
+        front = back;
+        return true;
+    }
+
+    Ref<ImageTexture> get_texture() const {
+        if (front < 0 || front >= (int)slots.size()) return nullptr;
+        return slots[front].texture;
+    }
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,134 @@
+#ifndef _RIVEEXTENSION_TILE_GRID_HPP_
+#define _RIVEEXTENSION_TILE_GRID_HPP_
+
+// stdlib
+#include <map>
+#include <utility>
+
+// godot-cpp
+#include <godot_cpp/classes/image.hpp>
+#include <godot_cpp/classes/image_texture.hpp>
+#include <godot_cpp/classes/ref.hpp>
+
+// skia
+#include <skia/dependencies/skia/include/core/SkRect.h>
+
+// extension
+#include "rive_exceptions.hpp"
+#include "utils/types.hpp"
+#include "viewer_props.hpp"
+
+using namespace godot;
+
+/* Tiles kept around the viewport in every direction, so panning finds them already rasterized. */
+static const int TILE_PREFETCH = 1;
+
+/**
+ * Most tiles alive at once, about 128 MB in RGBA8. The prefetch ring goes first; visible tiles are only dropped past
+ * this, when a view is zoomed out below the lowest level of detail.
+ */
+static const int MAX_VIRTUAL_TILES = 128;
+
+/**
+ * The textures of a viewer too large to rasterize at once. Only the tiles around the viewport exist: tiles that
+ * scroll out of range are freed, and tiles that scroll in start out empty until they're rasterized.
+ *
+ * Tiles are addressed by column and row. Their pixel rectangles are in raster space, `VIRTUAL_TILE_SIZE` apart.
+ */
+struct TileGrid {
+    struct Tile {
+        Ref<Image> image;
+        Ref<ImageTexture> texture;
+        bool rasterized = false;
+        bool dirty = false;
+    };
+
+   private:
+    std::map<std::pair<int, int>, Tile> tiles;
+    SkIRect range = SkIRect::MakeEmpty();
+    bool capped = false;
+
+    static int64_t count(const SkIRect &columns_rows) {
+        return (int64_t)columns_rows.width() * columns_rows.height();
+    }
+
+   public:
+    /* Bytes pushed to the textures so far. */
+    uint64_t uploaded_bytes = 0;
+
+    static SkIRect tile_rect(int column, int row) {
+        return SkIRect::MakeXYWH(
+            column * VIRTUAL_TILE_SIZE, row * VIRTUAL_TILE_SIZE, VIRTUAL_TILE_SIZE, VIRTUAL_TILE_SIZE
+        );
+    }
+
+    void clear() {
+        tiles.clear();
+        range.setEmpty();
+        capped = false;
+    }
+
+    /* Marks every tile as needing a full raster, e.g. after the layout changed. */
+    void invalidate() {
+        for (auto &entry : tiles) entry.second.rasterized = false;
+    }
+
+    /**
+     * Keeps the tiles covering `visible` and `TILE_PREFETCH` more around it, within `grid` (both in tile units),
+     * frees the others and creates the missing ones. When that's more than `MAX_VIRTUAL_TILES`, only the visible
+     * tiles are kept, and if even those are too many, they're trimmed from the edges of the view.
+     */
+    void set_range(const SkIRect &visible, const SkIRect &grid, Image::Format format) {
+        SkIRect shown = visible;
+        range = visible.makeOutset(TILE_PREFETCH, TILE_PREFETCH);
+        if (!shown.intersect(grid)) shown.setEmpty();
+        if (!range.intersect(grid)) range.setEmpty();
+        if (count(range) > MAX_VIRTUAL_TILES) range = shown;
+        bool over = count(range) > MAX_VIRTUAL_TILES;
+        if (over && !capped) {
+            String visible_count = String::num_int64(count(range));
+            String kept_count = String::num_int64(MAX_VIRTUAL_TILES);
+            RiveException("The view covers " + visible_count + " virtual tiles, only the middle " + kept_count
+                          + " are rasterized")
+                .from("TileGrid", "set_range")
+                .warning()
+                .report();
+        }
+        capped = over;
+        while (count(range) > MAX_VIRTUAL_TILES) {
+            if (range.width() >= range.height()) range.inset(1, 0);
+            else range.inset(0, 1);
+        }
+        for (auto it = tiles.begin(); it != tiles.end();) {
+            if (range.contains(it->first.first, it->first.second)) it++;
+            else it = tiles.erase(it);
+        }
+        for (int row = range.top(); row < range.bottom(); row++)
+            for (int column = range.left(); column < range.right(); column++) {
+                Tile &tile = tiles[{ column, row }];
+                if (tile.image.is_valid()) continue;
+                tile.image = Image::create(VIRTUAL_TILE_SIZE, VIRTUAL_TILE_SIZE, false, format);
+            }
+    }
+
+    void for_each(Fn<void, const SkIRect &, Tile &> fn) {
+        for (auto &entry : tiles) fn(tile_rect(entry.first.first, entry.first.second), entry.second);
+    }
+
+    /* Pushes the images that changed since the last upload to their textures. Returns whether any did. */
+    bool upload() {
+        bool uploaded = false;
+        for (auto &entry : tiles) {
+            Tile &tile = entry.second;
+            if (!tile.dirty) continue;
+            if (tile.texture.is_null()) tile.texture = ImageTexture::create_from_image(tile.image);
+            else tile.texture->update(tile.image);
+            uploaded_bytes += tile.image->get_data().size();
+            tile.dirty = false;
+            uploaded = true;
+        }
+        return uploaded;
+    }
+};
+
+#endif
\ No newline at end of file
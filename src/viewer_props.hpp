@@ -2,6 +2,8 @@
 #define _RIVEEXTENSION_VIEWER_PROPS_HPP_
 
 // stdlib
+#include <algorithm>
+#include <cmath>
 #include <functional>
 
 // godot-cpp
@@ -77,6 +79,25 @@ static rive::Alignment convert(ALIGN alignment) {
     }
 }
 
+enum PIXEL_FORMAT { RGBA8 = 0, NATIVE = 1, RGBA4444 = 2, RGB565 = 3, L8 = 4 };
+
+static const char *PixelFormatEnumPropertyHint = "RGBA8:0,Native:1,RGBA4444:2,RGB565:3,L8:4";
+
+enum THREADING { MAIN = 0, PIPELINED = 1, PARALLEL = 2 };
+
+static const char *ThreadingEnumPropertyHint = "Main:0,Pipelined:1,Parallel:2";
+
+enum ANTIALIASING { AA_ON = 0, AA_OFF = 1, AA_AUTO = 2 };
+
+static const char *AntialiasingEnumPropertyHint = "On:0,Off:1,Auto:2";
+
+static const float MIN_RENDER_SCALE = 0.25;
+static const float MAX_LOD_SCALE = 4.0;
+static const int VIRTUAL_TILE_SIZE = 512;
+
+/* Changes that are collected by the setters and applied together by `ViewerProps::commit()`. */
+enum PROP_DIRTY { DIRTY_SIZE = 1 << 0, DIRTY_TRANSFORM = 1 << 1 };
+
 template <typename... Args>
 using Callback = function<void(Args...)>;
 
@@ -106,12 +127,32 @@ struct ViewerProps {
     bool _disable_press = false;
     bool _disable_hover = false;
     bool _paused = false;
+    bool _auto_sleep = false;
+    bool _premultiplied_alpha = false;
+    int _buffer_count = 1;
+    THREADING _threading = THREADING::MAIN;
+    bool _atlas = false;
+    int _max_fps = 0;
+    float _render_scale = 1.0;
+    float _frame_budget = 0.0;
+    float _auto_scale = 1.0;
+    bool _opaque = false;
+    bool _auto_lod = false;
+    bool _tiled = false;
+    bool _virtual_tiles = false;
+    bool _layer_cache = false;
+    int _bake_fps = 0;
+    int _share_group = -1;
+    ANTIALIASING _antialiasing = ANTIALIASING::AA_ON;
+    float _lod_scale = 1.0;
+    Rect2i _content_rect;
     int _artboard = -1;
     int _scene = -1;
     int _animation = -1;
     Dictionary _scene_properties;
     FIT _fit = FIT::CONTAIN;
     ALIGN _alignment = ALIGN::CENTER;
+    PIXEL_FORMAT _pixel_format = PIXEL_FORMAT::RGBA8;
 
     /* Events */
     PropEvent<String> path_changed;
@@ -121,6 +162,15 @@ struct ViewerProps {
     PropEvent<int> animation_changed;
     PropEvent<float, float> size_changed;
     PropEvent<> transform_changed;
+    PropEvent<> dirtied;
+
+    int dirty = 0;
+
+    void mark_dirty(int flags) {
+        bool was_dirty = is_dirty();
+        dirty |= flags;
+        if (!was_dirty) dirtied.emit();
+    }
 
    public:
     /* Event handlers */
@@ -152,6 +202,26 @@ struct ViewerProps {
         size_changed.subscribe(callback);
     }
 
+    /* Called when the first uncommitted change is made. */
+    void on_dirty(Callback<> callback) {
+        dirtied.subscribe(callback);
+    }
+
+    bool is_dirty() const {
+        return dirty != 0;
+    }
+
+    /**
+     * Emits the size and transform events for everything that changed since the last commit, once each. Setters
+     * only mark what changed, so a container resize or several properties set in a row reallocate and render once.
+     */
+    void commit() {
+        int flags = dirty;
+        dirty = 0;
+        if (flags & DIRTY_SIZE) size_changed.emit(_width, _height);
+        if (flags & (DIRTY_SIZE | DIRTY_TRANSFORM)) transform_changed.emit();
+    }
+
     /* Getters */
 
     String path() const {
@@ -198,6 +268,10 @@ struct ViewerProps {
         return convert(_alignment);
     }
 
+    PIXEL_FORMAT pixel_format() const {
+        return _pixel_format;
+    }
+
     bool disable_press() const {
         return _disable_press;
     }
@@ -210,6 +284,103 @@ struct ViewerProps {
         return _paused;
     }
 
+    bool auto_sleep() const {
+        return _auto_sleep;
+    }
+
+    bool premultiplied_alpha() const {
+        return _premultiplied_alpha;
+    }
+
+    int buffer_count() const {
+        return _buffer_count;
+    }
+
+    THREADING threading() const {
+        return _threading;
+    }
+
+    bool atlas() const {
+        return _atlas;
+    }
+
+    int max_fps() const {
+        return _max_fps;
+    }
+
+    float render_scale() const {
+        return _render_scale;
+    }
+
+    float frame_budget() const {
+        return _frame_budget;
+    }
+
+    float auto_scale() const {
+        return _auto_scale;
+    }
+
+    /* Whether the current artboard covers the whole viewer with an opaque background. */
+    bool opaque() const {
+        return _opaque;
+    }
+
+    /**
+     * The resolution of the rasterized surface relative to the viewer's size. Virtualized viewers always follow the
+     * level of detail, so zooming out lowers the resolution instead of bringing more tiles into view.
+     */
+    float raster_scale() const {
+        float lod = _auto_lod || _virtual_tiles ? _lod_scale : 1.0f;
+        return std::clamp(_render_scale * _auto_scale, MIN_RENDER_SCALE, 1.0f) * lod;
+    }
+
+    bool auto_lod() const {
+        return _auto_lod;
+    }
+
+    bool tiled() const {
+        return _tiled;
+    }
+
+    bool virtual_tiles() const {
+        return _virtual_tiles;
+    }
+
+    bool layer_cache() const {
+        return _layer_cache;
+    }
+
+    int bake_fps() const {
+        return _bake_fps;
+    }
+
+    int share_group() const {
+        return _share_group;
+    }
+
+    ANTIALIASING antialiasing() const {
+        return _antialiasing;
+    }
+
+    float lod_scale() const {
+        return _lod_scale;
+    }
+
+    /* The part of the viewer the artboard is drawn in. The surface only covers this rectangle. */
+    Rect2i content_rect() const {
+        Rect2i full = Rect2i(0, 0, width(), height());
+        Rect2i content = _content_rect.intersection(full);
+        return content.has_area() ? content : full;
+    }
+
+    int raster_width() const {
+        return std::max((int)std::round(content_rect().size.x * raster_scale()), 1);
+    }
+
+    int raster_height() const {
+        return std::max((int)std::round(content_rect().size.y * raster_scale()), 1);
+    }
+
     Dictionary scene_properties() const {
         return _scene_properties;
     }
@@ -235,24 +406,21 @@ struct ViewerProps {
     void width(int value) {
         if (value != _width) {
             _width = value;
-            size_changed.emit(_width, _height);
-            transform_changed.emit();
+            mark_dirty(DIRTY_SIZE);
         }
     }
 
     void height(int value) {
         if (value != _height) {
             _height = value;
-            size_changed.emit(_width, _height);
-            transform_changed.emit();
+            mark_dirty(DIRTY_SIZE);
         }
     }
 
     void size(int w, int h) {
         if (_width != w || _height != h) {
             _width = w, _height = h;
-            size_changed.emit(_width, _height);
-            transform_changed.emit();
+            mark_dirty(DIRTY_SIZE);
         }
     }
 
@@ -262,7 +430,7 @@ struct ViewerProps {
             animation(-1);
             _artboard = index;
             artboard_changed.emit(index);
-            transform_changed.emit();
+            mark_dirty(DIRTY_TRANSFORM);
         }
     }
 
@@ -285,13 +453,20 @@ struct ViewerProps {
     void fit(FIT value) {
         if (value != _fit) {
             _fit = value;
-            transform_changed.emit();
+            mark_dirty(DIRTY_TRANSFORM);
         }
     }
 
     void alignment(ALIGN value) {
         _alignment = value;
-        transform_changed.emit();
+        mark_dirty(DIRTY_TRANSFORM);
+    }
+
+    void pixel_format(PIXEL_FORMAT value) {
+        if (value != _pixel_format) {
+            _pixel_format = value;
+            mark_dirty(DIRTY_SIZE);
+        }
     }
 
     void disable_press(bool value) {
@@ -312,6 +487,132 @@ struct ViewerProps {
         }
     }
 
+    void auto_sleep(bool value) {
+        if (_auto_sleep != value) {
+            _auto_sleep = value;
+        }
+    }
+
+    void buffer_count(int value) {
+        if (_buffer_count != value) {
+            _buffer_count = value;
+            mark_dirty(DIRTY_SIZE);
+        }
+    }
+
+    void threading(THREADING value) {
+        if (_threading != value) {
+            _threading = value;
+            mark_dirty(DIRTY_SIZE);
+        }
+    }
+
+    void atlas(bool value) {
+        if (_atlas != value) {
+            _atlas = value;
+            mark_dirty(DIRTY_SIZE);
+        }
+    }
+
+    void max_fps(int value) {
+        if (_max_fps != value) {
+            _max_fps = value;
+        }
+    }
+
+    void render_scale(float value) {
+        if (_render_scale != value) {
+            _render_scale = value;
+            mark_dirty(DIRTY_SIZE);
+        }
+    }
+
+    void frame_budget(float value) {
+        if (_frame_budget != value) {
+            _frame_budget = value;
+        }
+    }
+
+    void auto_scale(float value) {
+        if (_auto_scale != value) {
+            _auto_scale = value;
+            mark_dirty(DIRTY_SIZE);
+        }
+    }
+
+    void auto_lod(bool value) {
+        if (_auto_lod != value) {
+            _auto_lod = value;
+            mark_dirty(DIRTY_SIZE);
+        }
+    }
+
+    void tiled(bool value) {
+        if (_tiled != value) {
+            _tiled = value;
+        }
+    }
+
+    void virtual_tiles(bool value) {
+        if (_virtual_tiles != value) {
+            _virtual_tiles = value;
+            mark_dirty(DIRTY_SIZE);
+        }
+    }
+
+    void layer_cache(bool value) {
+        if (_layer_cache != value) {
+            _layer_cache = value;
+        }
+    }
+
+    void bake_fps(int value) {
+        if (_bake_fps != value) {
+            _bake_fps = value;
+        }
+    }
+
+    void share_group(int value) {
+        if (_share_group != value) {
+            _share_group = value;
+        }
+    }
+
+    void antialiasing(ANTIALIASING value) {
+        if (_antialiasing != value) {
+            _antialiasing = value;
+            mark_dirty(DIRTY_TRANSFORM);
+        }
+    }
+
+    void lod_scale(float value) {
+        if (_lod_scale != value) {
+            _lod_scale = value;
+            if (_auto_lod || _virtual_tiles) mark_dirty(DIRTY_SIZE);
+        }
+    }
+
+    void content_rect(Rect2i value) {
+        if (_content_rect != value) {
+            _content_rect = value;
+            mark_dirty(DIRTY_SIZE);
+        }
+    }
+
+    void opaque(bool value) {
+        if (_opaque != value) {
+            _opaque = value;
+            mark_dirty(DIRTY_TRANSFORM);
+        }
+    }
+
+    void premultiplied_alpha(bool value) {
+        if (_premultiplied_alpha != value) {
+            _premultiplied_alpha = value;
+            mark_dirty(DIRTY_SIZE);
+        }
+    }
+
     void scene_properties(Dictionary value) {
         if (_scene_properties != value) {
             _scene_properties = value;